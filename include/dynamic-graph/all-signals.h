@@ -8,6 +8,7 @@
 
 // Utility header files including all signal headers
 
+#include <dynamic-graph/signal-input.h>
 #include <dynamic-graph/signal-ptr.h>
 #include <dynamic-graph/signal-time-dependent.h>
 #include <dynamic-graph/signal.h>
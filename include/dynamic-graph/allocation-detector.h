@@ -0,0 +1,86 @@
+// -*- mode: c++ -*-
+// Copyright 2020, LAAS-CNRS
+//
+
+#ifndef DYNAMIC_GRAPH_ALLOCATION_DETECTOR_H
+#define DYNAMIC_GRAPH_ALLOCATION_DETECTOR_H
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+#include <boost/noncopyable.hpp>
+
+#include <dynamic-graph/dynamic-graph-api.h>
+
+namespace dynamicgraph {
+/// \ingroup debug
+///
+/// \brief Detection of the memory allocations done while signals are
+/// evaluated, which break the real-time constraints of the control loop.
+///
+/// The allocations are only seen when the program is linked with the
+/// dynamic-graph-allocation-hooks library (or when it is preloaded with
+/// LD_PRELOAD), which intercepts malloc, calloc and realloc. Then, while
+/// the detector is enabled, each allocation done inside Signal::access() is
+/// attributed to the signal being evaluated (the innermost one when the
+/// evaluation of a signal accesses other signals), with the call stack
+/// which led to it. The report is available through
+/// PoolStorage::writeAllocationReport().
+///
+/// When the detector is disabled, the cost on the evaluation of a signal is
+/// the test of a flag.
+class DYNAMIC_GRAPH_DLLAPI AllocationDetector {
+public:
+  static void enable(const bool &b = true) {
+    enabled.store(b, std::memory_order_relaxed);
+  }
+  static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+  /// Forget the allocations recorded so far.
+  static void clear();
+
+  /// Total number of allocations recorded.
+  static std::size_t getNbAllocations();
+
+  /// Write, for each entity and signal, the number of allocations, their
+  /// size and the call stacks at which they occurred.
+  static void report(std::ostream &os);
+
+  /// Called by the hooks for each allocation of size bytes.
+  static void record(const std::size_t &size);
+
+  /// Only defined by the hooks library: return true if the allocations are
+  /// intercepted on this platform. Calling it also prevents the linker from
+  /// dropping the hooks library as unused.
+  static bool hasHooks();
+
+  /// Attribute the allocations of the current thread to the signal named
+  /// name during the life of the object.
+  class Scope : private boost::noncopyable {
+  public:
+    explicit Scope(const std::string &name)
+        : active(isEnabled()), previous(NULL) {
+      if (active)
+        previous = enter(&name);
+    }
+    ~Scope() {
+      if (active)
+        leave(previous);
+    }
+
+  private:
+    const bool active;
+    const std::string *previous;
+  };
+
+private:
+  static const std::string *enter(const std::string *name);
+  static void leave(const std::string *previous);
+
+  static std::atomic<bool> enabled;
+};
+
+} // end of namespace dynamicgraph
+
+#endif //! DYNAMIC_GRAPH_ALLOCATION_DETECTOR_H
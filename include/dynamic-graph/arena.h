@@ -0,0 +1,90 @@
+// -*- mode: c++ -*-
+// Copyright 2020, LAAS-CNRS
+//
+
+#ifndef DYNAMIC_GRAPH_ARENA_H
+#define DYNAMIC_GRAPH_ARENA_H
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <new>
+
+#include <boost/noncopyable.hpp>
+
+#include <dynamic-graph/dynamic-graph-api.h>
+
+namespace dynamicgraph {
+/// \ingroup dgraph
+///
+/// \brief Memory in which the objects are placed one after the other, in
+/// large blocks, and which is only freed as a whole.
+///
+/// Objects allocated consecutively, such as an entity, the signals and the
+/// commands it creates, are contiguous in memory, instead of being spread
+/// over the heap. Freeing an object does not give its memory back: the
+/// blocks are freed when the arena is destroyed.
+class DYNAMIC_GRAPH_DLLAPI Arena : private boost::noncopyable {
+public:
+  static const std::size_t DEFAULT_BLOCK_SIZE = 1 << 20;
+
+  explicit Arena(std::size_t blockSize = DEFAULT_BLOCK_SIZE);
+  ~Arena();
+
+  /// Allocate size bytes, aligned on alignment, a power of two. By default,
+  /// with the alignment of any standard type. Allocations larger than the
+  /// blocks get a block of their own.
+  void *allocate(std::size_t size,
+                 std::size_t alignment = alignof(std::max_align_t));
+
+  /// Whether ptr points in the memory of the arena.
+  bool contains(const void *ptr) const;
+
+  /// Number of bytes allocated so far.
+  std::size_t getSize() const;
+  std::size_t getNbBlocks() const;
+
+private:
+  const std::size_t blockSize;
+  /// Size of the blocks, by address.
+  std::map<const char *, std::size_t> blocks;
+  char *current;
+  std::size_t remaining;
+  std::size_t size;
+  mutable std::mutex mutex;
+};
+
+/// \ingroup dgraph
+///
+/// \brief Base class of the objects which are placed in the arena of the
+/// pool, when the pool has one (see PoolStorage::enableArena()).
+///
+/// The objects created while the pool has no arena are allocated on the
+/// heap, as usual, without overhead: deleting an object asks the arena
+/// whether it holds it. The objects placed in the arena must be deleted
+/// before the pool is destroyed.
+///
+/// The alignment of the types is honoured up to the one of std::max_align_t
+/// in C++11, as by the global operator new, and for any type from C++17.
+class DYNAMIC_GRAPH_DLLAPI ArenaAllocated {
+public:
+  static void *operator new(std::size_t size);
+  static void operator delete(void *ptr);
+#ifdef __cpp_aligned_new
+  static void *operator new(std::size_t size, std::align_val_t alignment);
+  static void operator delete(void *ptr, std::align_val_t alignment);
+#endif
+
+  /// The class-scope operator new hides the global ones: placement new and
+  /// nothrow new are declared again.
+  static void *operator new(std::size_t, void *ptr) noexcept { return ptr; }
+  static void operator delete(void *, void *) noexcept {}
+  static void *operator new(std::size_t size,
+                            const std::nothrow_t &) noexcept;
+  static void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+    ArenaAllocated::operator delete(ptr);
+  }
+};
+
+} // end of namespace dynamicgraph
+
+#endif //! DYNAMIC_GRAPH_ARENA_H
@@ -7,6 +7,7 @@
 #ifndef DYNAMIC_GRAPH_COMMAND_H
 #define DYNAMIC_GRAPH_COMMAND_H
 
+#include "dynamic-graph/arena.h"
 #include "dynamic-graph/dynamic-graph-api.h"
 #include "dynamic-graph/value.h"
 #include <vector>
@@ -31,7 +32,7 @@ namespace command {
 /// Parameters are set by calling Command::setParameterValues with a
 /// vector of Values the types of which should fit the vector specified
 /// at construction.
-class DYNAMIC_GRAPH_DLLAPI Command {
+class DYNAMIC_GRAPH_DLLAPI Command : public ArenaAllocated {
 public:
   virtual ~Command();
   /// Store the owner entity and a vector of value types
@@ -5,13 +5,18 @@
 
 #ifndef DYNAMIC_GRAPH_ENTITY_H
 #define DYNAMIC_GRAPH_ENTITY_H
+#include <atomic>
 #include <iosfwd>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 
 #include <boost/noncopyable.hpp>
 
+#include <dynamic-graph/arena.h>
 #include <dynamic-graph/dynamic-graph-api.h>
 #include <dynamic-graph/exception-factory.h>
 #include <dynamic-graph/fwd.hh>
@@ -50,9 +55,12 @@ namespace dynamicgraph {
 /// These signals link the entities together to form a complete
 /// computation graph.  To declare a new entity, please see the
 /// DYNAMICGRAPH_FACTORY_ENTITY_PLUGIN macro in factory.h.
-class DYNAMIC_GRAPH_DLLAPI Entity : private boost::noncopyable {
+class DYNAMIC_GRAPH_DLLAPI Entity : private boost::noncopyable,
+                                   public ArenaAllocated {
 public:
   typedef std::map<std::string, SignalBase<int> *> SignalMap;
+  typedef std::unordered_map<std::string, SignalBase<int> *> SignalIndex;
+  typedef std::shared_ptr<const SignalMap> SignalMapSnapshot;
   typedef std::map<const std::string, command::Command *> CommandMap_t;
 
   explicit Entity(const std::string &name);
@@ -105,6 +113,11 @@ public:
    */
   virtual std::ostream &writeCompletionList(std::ostream &os) const;
 
+  /** \brief Write the profiling counters of the signals of the entity
+      (see SignalProfile), preceded by their sum over the entity.
+   */
+  std::ostream &writeProfile(std::ostream &os) const;
+
   /** \brief Display information on the entity inside the output stream os.
    */
   virtual void display(std::ostream &os) const;
@@ -130,6 +143,13 @@ public:
    */
   SignalMap getSignalMap() const;
 
+  /** \brief Copy of the map of the signals, as of the last registration
+      or deregistration of a signal.
+      It can be read by any thread while the signals are registered, as
+      PoolStorage::getEntitySnapshot().
+   */
+  SignalMapSnapshot getSignalSnapshot() const;
+
   /// \name Logger related methods
   /// \{
 
@@ -174,6 +194,14 @@ protected:
 
   std::string name;
   SignalMap signalMap;
+  // Hashed copy of signalMap, for the lookups by name.
+  SignalIndex signalIndex;
+  // Copy of signalMap for the other threads, made by getSignalSnapshot()
+  // after a change.
+  mutable SignalMapSnapshot signalSnapshot;
+  mutable std::atomic<bool> signalsChanged;
+  // Protects signalMap against getSignalSnapshot().
+  mutable std::mutex signalsMutex;
   CommandMap_t commandMap;
   Logger logger_;
 };
@@ -0,0 +1,322 @@
+// -*- mode: c++ -*-
+// Copyright 2020, LAAS-CNRS
+//
+
+#ifndef DYNAMIC_GRAPH_EXECUTION_PLAN_H
+#define DYNAMIC_GRAPH_EXECUTION_PLAN_H
+#include <algorithm>
+#include <map>
+#include <ostream>
+#include <vector>
+
+#include <boost/bind.hpp>
+
+#include <dynamic-graph/exception-signal.h>
+#include <dynamic-graph/fwd.hh>
+#include <dynamic-graph/signal-base.h>
+#include <dynamic-graph/thread-pool.h>
+
+namespace dynamicgraph {
+/// \ingroup dgraph
+///
+/// \brief Flattened evaluation order of the part of the graph needed
+/// to compute a set of sink signals.
+///
+/// The signals reachable from the sinks are sorted topologically once,
+/// so that runTick() can evaluate them in a single pass. As every signal is
+/// evaluated after all its dependencies, the needUpdate() check done on
+/// access stops at the first level instead of walking the whole sub-graph.
+///
+/// The plan is frozen: it is automatically recompiled on the next call to
+/// runTick() when the topology of the graph changed (plug, dependency
+/// edition, signal destruction). A sink which is destroyed is removed from
+/// the plan.
+///
+/// Signals that only forward the value of another one (i.e. plugged
+/// SignalPtr) are traversed but not stored in the plan.
+///
+/// The signals are grouped by level: a signal only depends on signals of
+/// lower levels. The signals of a level can thus be evaluated in parallel
+/// (see runTick(const Time&, ThreadPool&)). Each signal is still computed
+/// exactly once per tick, from the same inputs as in a serial evaluation,
+/// which gives the same results, provided that:
+/// \li the functions of the signals only access the signals declared as
+/// their dependencies, and do not share mutable state;
+/// \li the dependencies accessed from several signals of the same level are
+/// constants, TimeDependency::TIME_DEPENDENT or
+/// TimeDependency::VERSION_DEPENDENT signals: a plain function
+/// Signal, or an ALWAYS_READY or BOOL_DEPENDENT one, is recomputed or
+/// checked on each access, hence concurrently.
+template <class Time> class ExecutionPlan {
+public:
+  typedef std::vector<SignalBase<Time> *> Signals;
+
+  ExecutionPlan()
+      : levelBegin(0), tickTime(NULL), revision(0), compiled(false),
+        sinkWatcher(*this) {}
+  ~ExecutionPlan() { clearSinks(); }
+
+  /// \name Sinks
+  /// \{
+  void addSink(SignalBase<Time> &sig);
+  void removeSink(const SignalBase<Time> &sig);
+  void clearSinks();
+  const Signals &getSinks() const { return sinks; }
+  /// \}
+
+  /// Sort the signals reachable from the sinks in evaluation order.
+  void compile();
+
+  /// Return true if the plan has been compiled since the last topology
+  /// modification.
+  bool isValid() const {
+    return compiled && (revision == SignalBase<Time>::getGraphRevision());
+  }
+
+  /// Evaluate all the signals of the plan at time t, recompiling first if
+  /// necessary.
+  void runTick(const Time &t);
+
+  /// Same as runTick(const Time&), evaluating the signals of each level on
+  /// the threads of pool.
+  void runTick(const Time &t, ThreadPool &pool);
+
+  /// Evaluate the plan at each time from t0 to t1 included, e.g. to replay
+  /// recorded inputs offline. The plan is only recompiled if the topology
+  /// changes during the run. Tracers given as sinks should not flush their
+  /// files on each record (see Tracer::setTraceStyle()).
+  void runBatch(const Time &t0, const Time &t1);
+  void runBatch(const Time &t0, const Time &t1, ThreadPool &pool);
+
+  /// Signals in evaluation order.
+  const Signals &getOrder() const { return order; }
+
+  /// Number of levels of the plan.
+  std::size_t getNbLevels() const {
+    return levels.empty() ? 0 : levels.size() - 1;
+  }
+
+  /// Signals of level i are getOrder()[getLevelBegin(i)] to
+  /// getOrder()[getLevelBegin(i+1) - 1].
+  std::size_t getLevelBegin(const std::size_t &i) const { return levels[i]; }
+
+  std::ostream &display(std::ostream &os) const;
+
+protected:
+  enum VisitState { VISITING, VISITED };
+  struct Visit {
+    VisitState state;
+    // Level of the signal, or of the signal it forwards.
+    std::size_t level;
+  };
+  typedef std::map<const SignalBase<Time> *, Visit> VisitMap;
+  typedef std::vector<std::pair<std::size_t, SignalBase<Time> *> > Nodes;
+
+  std::size_t visit(const SignalBase<Time> *sig, VisitMap &visited,
+                    std::vector<const SignalBase<Time> *> &deps, Nodes &nodes);
+  // Task of the parallel evaluation: evaluate the i-th signal of the
+  // current level. The signals of a level do not depend on each other: the
+  // update epoch is incremented once at the end of the level (see
+  // evaluateLevel()) instead of by each thread for each signal.
+  void evaluate(const std::size_t &i) {
+    struct Deferral {
+      Deferral() { SignalBase<Time>::setUpdateEpochDeferred(true); }
+      ~Deferral() { SignalBase<Time>::setUpdateEpochDeferred(false); }
+    } deferral;
+    order[levelBegin + i]->recompute(*tickTime);
+  }
+  // Evaluate the signals of level l on the threads of pool.
+  void evaluateLevel(const std::size_t &l, ThreadPool &pool,
+                     const ThreadPool::Task &task);
+
+  // Dependent of the sinks, which removes them from the plan when they are
+  // destroyed.
+  class SinkWatcher : public SignalBase<Time> {
+  public:
+    explicit SinkWatcher(ExecutionPlan<Time> &plan)
+        : SignalBase<Time>("ExecutionPlan"), plan(plan) {}
+    virtual void dependencyDestroyed(const SignalBase<Time> &sig) {
+      plan.removeSink(sig);
+    }
+    // The plan does not depend on the values of the sinks.
+    virtual void setDirty() {}
+
+  private:
+    ExecutionPlan<Time> &plan;
+  };
+
+  Signals sinks;
+  Signals order;
+  std::vector<std::size_t> levels;
+  std::size_t levelBegin;
+  const Time *tickTime;
+  unsigned long revision;
+  bool compiled;
+  SinkWatcher sinkWatcher;
+};
+
+/* -------------------------------------------- */
+
+template <class Time>
+void ExecutionPlan<Time>::addSink(SignalBase<Time> &sig) {
+  if (std::find(sinks.begin(), sinks.end(), &sig) == sinks.end()) {
+    sinks.push_back(&sig);
+    sig.addDependent(&sinkWatcher);
+    compiled = false;
+  }
+}
+
+template <class Time>
+void ExecutionPlan<Time>::removeSink(const SignalBase<Time> &sig) {
+  typename Signals::iterator it = std::find(sinks.begin(), sinks.end(), &sig);
+  if (it != sinks.end()) {
+    sinks.erase(it);
+    sig.removeDependent(&sinkWatcher);
+    compiled = false;
+  }
+}
+
+template <class Time> void ExecutionPlan<Time>::clearSinks() {
+  for (typename Signals::const_iterator it = sinks.begin(); it != sinks.end();
+       ++it)
+    (*it)->removeDependent(&sinkWatcher);
+  sinks.clear();
+  order.clear();
+  levels.clear();
+  compiled = false;
+}
+
+template <class Time> void ExecutionPlan<Time>::compile() {
+  VisitMap visited;
+  std::vector<const SignalBase<Time> *> deps;
+  Nodes nodes;
+  for (typename Signals::const_iterator it = sinks.begin(); it != sinks.end();
+       ++it)
+    visit(*it, visited, deps, nodes);
+
+  // Nodes are in topological order. A stable sort by level keeps it so.
+  std::stable_sort(nodes.begin(), nodes.end(),
+                   boost::bind(&Nodes::value_type::first, _1) <
+                       boost::bind(&Nodes::value_type::first, _2));
+  order.resize(nodes.size());
+  levels.clear();
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    order[i] = nodes[i].second;
+    while (levels.size() <= nodes[i].first)
+      levels.push_back(i);
+  }
+  levels.push_back(nodes.size());
+  // Fill the caches of the signals which push their updates, so that they
+  // are not written during a parallel evaluation.
+  for (typename Signals::const_iterator it = order.begin(); it != order.end();
+       ++it)
+    (*it)->pushesUpdates();
+
+  revision = SignalBase<Time>::getGraphRevision();
+  compiled = true;
+}
+
+template <class Time>
+std::size_t
+ExecutionPlan<Time>::visit(const SignalBase<Time> *sig, VisitMap &visited,
+                           std::vector<const SignalBase<Time> *> &deps,
+                           Nodes &nodes) {
+  typename VisitMap::iterator state = visited.find(sig);
+  if (state != visited.end()) {
+    if (state->second.state == VISITING) {
+      DG_THROW ExceptionSignal(ExceptionSignal::GENERIC,
+                               "Cycle in the signal graph.",
+                               " (while compiling the execution plan at <%s>)",
+                               sig->getName().c_str());
+    }
+    return state->second.level;
+  }
+  visited[sig].state = VISITING;
+
+  // deps is shared by the whole traversal: the dependencies of sig are
+  // appended at its end, and removed once they have been visited.
+  const std::size_t first = deps.size();
+  sig->collectDependencies(deps);
+  const std::size_t last = deps.size();
+  // Level of a signal is one plus the maximum level of its dependencies,
+  // a forwarder has the level of the signal it forwards.
+  std::size_t level = 0;
+  for (std::size_t i = first; i < last; ++i)
+    level = std::max(level, visit(deps[i], visited, deps, nodes) + 1);
+  deps.resize(first);
+  if (sig->isForwarder() && level > 0)
+    --level;
+
+  Visit &result = visited[sig];
+  result.state = VISITED;
+  result.level = level;
+  if (!sig->isForwarder()) {
+    // The graph only stores const pointers to the dependencies, but
+    // evaluating them is precisely what they are kept for.
+    nodes.push_back(std::make_pair(level, const_cast<SignalBase<Time> *>(sig)));
+  }
+  return level;
+}
+
+template <class Time> void ExecutionPlan<Time>::runTick(const Time &t) {
+  if (!isValid())
+    compile();
+  const typename Signals::const_iterator itend = order.end();
+  for (typename Signals::const_iterator it = order.begin(); it != itend; ++it)
+    (*it)->recompute(t);
+}
+
+template <class Time>
+void ExecutionPlan<Time>::runTick(const Time &t, ThreadPool &pool) {
+  if (!isValid())
+    compile();
+  const ThreadPool::Task task =
+      boost::bind(&ExecutionPlan<Time>::evaluate, this, _1);
+  tickTime = &t;
+  for (std::size_t l = 0; l + 1 < levels.size(); ++l)
+    evaluateLevel(l, pool, task);
+  tickTime = NULL;
+}
+
+template <class Time>
+void ExecutionPlan<Time>::evaluateLevel(const std::size_t &l, ThreadPool &pool,
+                                        const ThreadPool::Task &task) {
+  levelBegin = levels[l];
+  try {
+    pool.parallelFor(levels[l + 1] - levelBegin, task);
+  } catch (...) {
+    SignalBase<Time>::newUpdateEpoch();
+    throw;
+  }
+  // The modifications of the level, deferred by evaluate().
+  SignalBase<Time>::newUpdateEpoch();
+}
+
+template <class Time>
+void ExecutionPlan<Time>::runBatch(const Time &t0, const Time &t1) {
+  for (Time t = t0; !(t1 < t); ++t)
+    runTick(t);
+}
+
+template <class Time>
+void ExecutionPlan<Time>::runBatch(const Time &t0, const Time &t1,
+                                   ThreadPool &pool) {
+  for (Time t = t0; !(t1 < t); ++t)
+    runTick(t, pool);
+}
+
+template <class Time>
+std::ostream &ExecutionPlan<Time>::display(std::ostream &os) const {
+  os << "ExecutionPlan (" << order.size() << " signals"
+     << (isValid() ? "" : ", outdated") << ")";
+  for (typename Signals::const_iterator it = order.begin(); it != order.end();
+       ++it) {
+    os << std::endl << "  ";
+    (*it)->display(os);
+  }
+  return os;
+}
+
+} // end of namespace dynamicgraph
+
+#endif //! DYNAMIC_GRAPH_EXECUTION_PLAN_H
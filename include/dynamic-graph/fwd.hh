@@ -28,12 +28,15 @@ class TracerRealTime;
 
 template <typename T, typename Time> class Signal;
 
+template <typename Time> class ExecutionPlan;
+
 template <typename Time> class SignalArray;
 
 template <typename Time> class SignalArray_const;
 
 template <typename Time> class SignalBase;
 
+template <typename T, typename Time> class SignalInput;
 template <typename T, typename Time> class SignalPtr;
 template <typename T, typename Time> class SignalTimeDependent;
 template <typename Time> class TimeDependency;
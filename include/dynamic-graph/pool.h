@@ -5,12 +5,18 @@
 
 #ifndef DYNAMIC_GRAPH_POOL_H
 #define DYNAMIC_GRAPH_POOL_H
+#include <atomic>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 
+#include <dynamic-graph/arena.h>
 #include <dynamic-graph/dynamic-graph-api.h>
 #include <dynamic-graph/exception-factory.h>
+#include <dynamic-graph/execution-plan.h>
 #include <dynamic-graph/fwd.hh>
 #include <dynamic-graph/signal-base.h>
 
@@ -37,6 +43,9 @@ public:
   */
   /*! \brief Sorted set of entities with unique key (name). */
   typedef std::map<std::string, Entity *> Entities;
+  typedef std::unordered_map<std::string, Entity *> EntityIndex;
+  /*! \brief Immutable copy of the set of entities. */
+  typedef std::shared_ptr<const Entities> EntitiesSnapshot;
 
   /// \brief Get unique instance of the class.
   static PoolStorage *getInstance();
@@ -76,6 +85,19 @@ public:
   /// Const access to entity map
   const Entities &getEntityMap() const;
 
+  /*! \brief Copy of the entity map, as of the last registration or
+    deregistration of an entity.
+
+    Unlike getEntityMap(), it can be used by any thread while the entities
+    are registered and deregistered: the first call after a series of
+    changes makes a new copy, and the copies being read remain valid as long
+    as they are referenced. The call only waits for the thread modifying the
+    pool while it inserts or erases an entity. The entities themselves are
+    not kept alive by the copy: they must not be deleted while other threads
+    use them (see also Entity::getSignalSnapshot()).
+  */
+  EntitiesSnapshot getEntitySnapshot() const;
+
   /*! \brief Test if the entity exists. */
   bool existEntity(const std::string &name);
   /*! \brief Test if the entity exists. If it does, return a pointer on it. */
@@ -92,10 +114,105 @@ public:
   ///
   /// \param sigpath stream containing a string of the form "entity.signal"
   SignalBase<int> &getSignal(std::istringstream &sigpath);
+  /// \param sigpath string of the form "entity.signal"
+  SignalBase<int> &getSignal(const std::string &sigpath);
+
+  /// \brief Revision of the set of entities and signals, changed each time
+  /// an entity or a signal is registered or deregistered.
+  ///
+  /// A SignalHandle only looks its signal up again when the revision has
+  /// changed.
+  static unsigned long getRegistryRevision() { return registryRevision(); }
+  static void notifyRegistryChange() { ++registryRevision(); }
+
+  /*! \name Method related to the frozen evaluation of the graph.
+    @{
+  */
+  /*! \brief Execution plan of the graph.
+    Add the signals that must be computed at each tick as sinks of the plan.
+  */
+  ExecutionPlan<int> &getExecutionPlan() { return executionPlan; }
+
+  /*! \brief Evaluate all the signals needed by the sinks of the execution
+    plan at time t, recompiling the plan if the graph has changed.
+  */
+  void runTick(const int &t) { executionPlan.runTick(t); }
+  /*! @} */
+
+  /*! \name Method related to the placement of the objects in memory.
+    @{
+  */
+  /*! \brief Place the entities, signals and commands created from now on in
+    an arena (see ArenaAllocated), so that the objects created together are
+    contiguous in memory. The arena is freed as a whole when the pool is
+    destroyed: the objects placed in it which are not deleted by the pool
+    must be deleted before. Does nothing if the pool already has an arena.
+  */
+  void enableArena(std::size_t blockSize = Arena::DEFAULT_BLOCK_SIZE);
+
+  /*! \brief Arena of the pool, NULL if there is no pool or if the pool
+    has no arena. */
+  static Arena *getArena();
+  /*! @} */
+
+  /*! \brief Write the allocations done during the evaluation of signals
+    while the AllocationDetector is enabled, per entity and signal. */
+  void writeAllocationReport(std::ostream &os);
+  void writeAllocationReport(const std::string &aFileName);
+
+  /*! \brief Write the profiling counters of the signals, entity by
+    entity (see Entity::writeProfile()). */
+  void writeProfile(std::ostream &os);
+  void writeProfile(const std::string &aFileName);
+
+  /*! \name Snapshots of the graph.
+    @{
+  */
+  /*! \brief Write the entities, the plugs between their signals, the
+    constant values of the signals and their period, in binary form.
+
+    The entities are identified by their class and name, and the signals
+    by their name in their entity. The values are written in the byte order
+    of the machine (see signal_binary_io).
+  */
+  void writeSnapshot(std::ostream &os);
+  void writeSnapshot(const std::string &aFileName);
+
+  /*! \brief Rebuild the graph written by writeSnapshot(): create the
+    entities which do not exist yet, plug the signals and set their
+    constant values and periods.
+  */
+  void readSnapshot(std::istream &is);
+  void readSnapshot(const std::string &aFileName);
+  /*! @} */
 
   /*! \brief This method write a graph description on the file named
       FileName. */
   void writeGraph(const std::string &aFileName);
+
+  /*! \brief Write the graph in JSON: the entities with their signals, the
+    edges between the signals and the profiling counters of each signal
+    (see SignalProfile), which js/view_sot_dg.html can display.
+
+    The document is written while the graph is visited, without building
+    it in memory. It has the form
+    \code
+    {"entities": [{"name": ..., "class": ..., "totalTime": ...,
+                   "signals": [{"name": ..., "id": ..., "time": ...,
+                                "calls": ..., "recomputes": ...,
+                                "cacheHits": ..., "timed": ...,
+                                "lastTime": ..., "meanTime": ...,
+                                "maxTime": ..., "totalTime": ...}]}],
+     "edges": [{"from": ..., "to": ..., "type": "plug"|"dependency"}]}
+    \endcode
+    where the signals are identified by their full name (id), and the times
+    are in seconds. An edge goes from a signal to the signal reading it:
+    "plug" for an input plugged to a signal, "dependency" for the
+    dependencies of a signal. Its source may be a signal which is not
+    registered in an entity.
+  */
+  void writeGraphJson(std::ostream &os);
+  void writeGraphJson(const std::string &aFileName);
   void writeCompletionList(std::ostream &os);
 
 protected:
@@ -105,10 +222,33 @@ protected:
   */
   /*! \brief Set of basic objects of the SoT */
   Entities entityMap;
+  /*! \brief Hashed copy of entityMap, for the lookups by name. */
+  EntityIndex entityIndex;
+  /*! \brief Copy of entityMap for the other threads, made by
+    getEntitySnapshot() after a change. */
+  mutable EntitiesSnapshot entitySnapshot;
+  mutable std::atomic<bool> entitiesChanged;
+  /*! \brief Protects entityMap against getEntitySnapshot(). */
+  mutable std::mutex entitiesMutex;
+  /*! \brief Remove an entity from the maps and from the execution plan,
+    without notifying the change of the registry. */
+  void removeEntity(const Entities::iterator &entity);
+
+  /*! \brief Frozen evaluation order of the graph. */
+  ExecutionPlan<int> executionPlan;
+
+  /*! \brief Memory of the objects created while it is enabled. Destroyed
+    after the entities. */
+  std::unique_ptr<Arena> arena;
 
 private:
-  PoolStorage() {}
+  PoolStorage() : entitiesChanged(true) {}
   static PoolStorage *instance_;
+
+  static unsigned long &registryRevision() {
+    static unsigned long revision = 1;
+    return revision;
+  }
 };
 
 inline PoolStorage &g_pool() { return *PoolStorage::getInstance(); }
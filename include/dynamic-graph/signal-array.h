@@ -5,58 +5,57 @@
 
 #ifndef DYNAMIC_GRAPH_SIGNAL_ARRAY_H
 #define DYNAMIC_GRAPH_SIGNAL_ARRAY_H
+#include <boost/container/small_vector.hpp>
 #include <dynamic-graph/dynamic-graph-api.h>
 #include <dynamic-graph/signal-base.h>
 #include <stdio.h>
-#include <vector>
 
 namespace dynamicgraph {
 
 /// \ingroup dgraph
 ///
-/// \brief TODO
+/// \brief A list of signals, built with operator<<, used to declare the
+/// dependencies of a signal.
+///
+/// Up to INLINE_SIZE signals are stored in the object itself, so that
+/// building a short list such as <tt>sig1 << sig2 << sig3</tt> does not
+/// allocate memory.
 template <class Time> class SignalArray_const {
 
 public:
+  /// Kept for backward compatibility: the storage now grows as needed.
   static const int DEFAULT_SIZE = 20;
+  static const std::size_t INLINE_SIZE = 8;
 
 protected:
-  std::vector<const SignalBase<Time> *> const_array;
-  unsigned int size, rank;
+  typedef boost::container::small_vector<const SignalBase<Time> *,
+                                         INLINE_SIZE>
+      ConstArray;
+  ConstArray const_array;
 
 public:
-  SignalArray_const<Time>(const unsigned int &sizeARG = DEFAULT_SIZE)
-      : const_array(sizeARG), size(sizeARG), rank(0) {}
-
-  SignalArray_const<Time>(const SignalBase<Time> &sig)
-      : const_array(DEFAULT_SIZE), size(DEFAULT_SIZE), rank(0) {
-    addElmt(&sig);
+  SignalArray_const<Time>(const unsigned int &sizeARG = 0) {
+    const_array.reserve(sizeARG);
   }
 
-  SignalArray_const<Time>(const SignalArray<Time> &siga)
-      : const_array(siga.getSize()), size(siga.getSize()),
-        rank(siga.getSize()) {
-    for (unsigned int i = 0; i < rank; ++i)
-      const_array[i] = &siga[i];
+  SignalArray_const<Time>(const SignalBase<Time> &sig) { addElmt(&sig); }
+
+  SignalArray_const<Time>(const SignalArray<Time> &siga) {
+    const_array.reserve(siga.getSize());
+    for (unsigned int i = 0; i < siga.getSize(); ++i)
+      const_array.push_back(&siga[i]);
   }
 
-  SignalArray_const<Time>(const SignalArray_const<Time> &siga)
-      : const_array(siga.getSize()), size(siga.getSize()),
-        rank(siga.getSize()) {
-    for (unsigned int i = 0; i < rank; ++i)
-      const_array[i] = &siga[i];
+  SignalArray_const<Time>(const SignalArray_const<Time> &siga) {
+    const_array.reserve(siga.getSize());
+    for (unsigned int i = 0; i < siga.getSize(); ++i)
+      const_array.push_back(&siga[i]);
   }
 
   virtual ~SignalArray_const<Time>() {}
 
 protected:
-  void addElmt(const SignalBase<Time> *el) {
-    if (rank >= size) {
-      size += DEFAULT_SIZE;
-      const_array.resize(size);
-    }
-    const_array[rank++] = el;
-  }
+  void addElmt(const SignalBase<Time> *el) { const_array.push_back(el); }
 
 public:
   virtual SignalArray_const<Time> &operator<<(const SignalBase<Time> &sig) {
@@ -68,7 +67,9 @@ public:
   virtual const SignalBase<Time> &operator[](const unsigned int &idx) const {
     return *const_array[idx];
   }
-  virtual unsigned int getSize() const { return rank; }
+  virtual unsigned int getSize() const {
+    return static_cast<unsigned int>(const_array.size());
+  }
 };
 
 template <class Time>
@@ -81,45 +82,34 @@ SignalArray_const<Time> operator<<(const SignalBase<Time> &sig1,
 
 /// \ingroup dgraph
 ///
-/// \brief TODO
+/// \brief A list of non-constant signals (see SignalArray_const).
 template <class Time> class SignalArray : public SignalArray_const<Time> {
 public:
   using SignalArray_const<Time>::DEFAULT_SIZE;
-  using SignalArray_const<Time>::size;
-  using SignalArray_const<Time>::rank;
+  using SignalArray_const<Time>::INLINE_SIZE;
 
 protected:
-  mutable std::vector<SignalBase<Time> *> array;
+  typedef boost::container::small_vector<SignalBase<Time> *, INLINE_SIZE>
+      Array;
+  Array array;
 
 public:
-  SignalArray<Time>(const unsigned int &sizeARG = DEFAULT_SIZE)
-      : SignalArray_const<Time>(0), array(sizeARG) {
-    size = sizeARG;
+  SignalArray<Time>(const unsigned int &sizeARG = 0)
+      : SignalArray_const<Time>(0) {
+    array.reserve(sizeARG);
   }
 
-  SignalArray<Time>(SignalBase<Time> &sig)
-      : SignalArray_const<Time>(0), array(DEFAULT_SIZE) {
-    size = DEFAULT_SIZE;
+  SignalArray<Time>(SignalBase<Time> &sig) : SignalArray_const<Time>(0) {
     addElmt(&sig);
   }
 
   SignalArray<Time>(const SignalArray<Time> &siga)
-      : SignalArray_const<Time>(siga.getSize()), array(siga.getSize()) {
-    rank = siga.getSize();
-    for (unsigned int i = 0; i < rank; ++i)
-      array[i] = &siga[i];
-  }
+      : SignalArray_const<Time>(0), array(siga.array) {}
 
   virtual ~SignalArray<Time>() {}
 
 protected:
-  void addElmt(SignalBase<Time> *el) {
-    if (rank >= size) {
-      size += DEFAULT_SIZE;
-      array.resize(size);
-    }
-    array[rank++] = el;
-  }
+  void addElmt(SignalBase<Time> *el) { array.push_back(el); }
 
 public:
   virtual SignalArray<Time> &operator<<(SignalBase<Time> &sig) {
@@ -137,6 +127,9 @@ public:
   virtual SignalBase<Time> &operator[](const unsigned int &idx) const {
     return *array[idx];
   }
+  virtual unsigned int getSize() const {
+    return static_cast<unsigned int>(array.size());
+  }
 };
 
 template <class Time>
@@ -6,16 +6,32 @@
 
 #ifndef DYNAMIC_GRAPH_SIGNAL_BASE_H
 #define DYNAMIC_GRAPH_SIGNAL_BASE_H
+#include <algorithm>
+#include <atomic>
 #include <boost/noncopyable.hpp>
 #include <sstream>
 #include <string>
 #include <typeinfo>
+#include <vector>
 
+#include <dynamic-graph/arena.h>
 #include <dynamic-graph/exception-signal.h>
 #include <dynamic-graph/fwd.hh>
+#include <dynamic-graph/signal-profile.h>
 
 namespace dynamicgraph {
 
+/// \brief Holder of the dependencies of a signal other than the signal
+/// itself, such as TimeDependency, told when one of them is destroyed (see
+/// SignalBase::dependencyDestroyed()).
+template <class Time> class DependencyHolder {
+public:
+  virtual void removeDependency(const SignalBase<Time> &sig) = 0;
+
+protected:
+  ~DependencyHolder() {}
+};
+
 /** \brief The base class for signals: not to be used as such.
 
     Signal values can be accessed programmatically using the access
@@ -23,18 +39,32 @@ namespace dynamicgraph {
     value of the signal, which can involve an extra computation,
     while the latter accesses a cached value, or 'copy'.
 */
-template <class Time> class SignalBase : public boost::noncopyable {
+template <class Time>
+class SignalBase : public boost::noncopyable, public ArenaAllocated {
 public:
   explicit SignalBase(std::string name = "")
-      : name(name), signalTime(0), ready(false) {}
-
-  virtual ~SignalBase() {}
+      : name(name), signalTime(0), ready(false), version(0),
+        dependencyHolder(NULL) {}
+
+  virtual ~SignalBase() {
+    // The dependents must not keep a pointer on a destroyed signal.
+    std::vector<SignalBase<Time> *> toDetach;
+    toDetach.swap(dependents);
+    for (typename std::vector<SignalBase<Time> *>::const_iterator it =
+             toDetach.begin();
+         it != toDetach.end(); ++it)
+      (*it)->dependencyDestroyed(*this);
+    invalidateGraph();
+  }
 
   /// \name Time
   /// \{
   virtual const Time &getTime() const { return signalTime; }
 
-  virtual void setTime(const Time &t) { signalTime = t; }
+  virtual void setTime(const Time &t) {
+    signalTime = t;
+    newUpdateEpoch();
+  }
 
   const bool &getReady() const { return ready; }
 
@@ -61,10 +91,99 @@ public:
 
   virtual bool needUpdate(const Time &) const { return ready; }
 
-  inline void setReady(const bool sready = true) { ready = sready; }
+  /// Append to the vector the signals this one directly depends on.
+  virtual void collectDependencies(
+      std::vector<const SignalBase<Time> *> &) const {}
+
+  /// Return true if the signal only forwards the value of another signal,
+  /// and thus does not need to be evaluated on its own.
+  virtual bool isForwarder() const { return false; }
+
+  /// Called by the destructor of a signal this one depends on. By default,
+  /// the signal is removed from the holder of the dependencies of this one
+  /// (the TimeDependency whose leader it is), if any, or from its
+  /// dependencies.
+  virtual void dependencyDestroyed(const SignalBase<Time> &sig) {
+    if (NULL != dependencyHolder)
+      dependencyHolder->removeDependency(sig);
+    else
+      removeDependency(sig);
+  }
+
+  /// Revision of the graph topology. It is incremented each time a plug,
+  /// a dependency or the kind of a signal (constant, function...) is
+  /// modified, or when a signal is destroyed, so that structures computed
+  /// from the graph (see ExecutionPlan) can detect they are outdated.
+  static unsigned long getGraphRevision() { return graphRevision(); }
+
+  static void invalidateGraph() {
+    ++graphRevision();
+    newUpdateEpoch();
+  }
+
+  /// Epoch of the state of the graph used to decide whether signals need
+  /// to be updated: it is incremented each time the value, the time or the
+  /// ready flag of a signal, or the topology of the graph, is modified.
+  /// The result of a query which depends only on this state can be reused
+  /// as long as the epoch is unchanged (see TimeDependency::needUpdate()).
+  static unsigned long getUpdateEpoch() {
+    return updateEpoch().load(std::memory_order_relaxed);
+  }
+
+  static void newUpdateEpoch() {
+    if (!updateEpochDeferred())
+      updateEpoch().fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// While deferred in a thread, the modifications made by this thread do
+  /// not increment the update epoch: whoever defers it must call
+  /// newUpdateEpoch() once the modifications are done. The queries made
+  /// meanwhile must not depend on these modifications, as for the signals
+  /// of a level of an ExecutionPlan, whose threads would otherwise all
+  /// increment the epoch for each signal they evaluate.
+  static void setUpdateEpochDeferred(const bool &deferred) {
+    updateEpochDeferred() = deferred;
+  }
+
+  inline void setReady(const bool sready = true) {
+    if (ready != sready) {
+      ready = sready;
+      newUpdateEpoch();
+    }
+  }
 
   virtual std::ostream &writeGraph(std::ostream &os) const { return os; }
 
+  /// \}
+
+  /// \name Push-based update
+  /// \{
+
+  /// Number of times the value of the signal has been set or computed.
+  unsigned long getVersion() const { return version; }
+
+  /// Return true if the signal notifies its dependents (see setDirty())
+  /// each time its value changes, so that they do not need to poll it.
+  virtual bool pushesUpdates() const { return false; }
+
+  /// Called when a signal this one depends on has been modified. By
+  /// default, the notification is forwarded to the dependents.
+  virtual void setDirty() { notifyDependents(); }
+
+  /// Identifier of the propagation of a modification to the dependents in
+  /// progress in the thread, 0 if none (see beginNotification()).
+  static unsigned long getNotificationRound() { return notificationRound(); }
+
+  /// Reverse edges of the graph: the signals depending on this one.
+  const std::vector<SignalBase<Time> *> &getDependents() const {
+    return dependents;
+  }
+  void addDependent(SignalBase<Time> *sig) const { dependents.push_back(sig); }
+  void removeDependent(SignalBase<Time> *sig) const {
+    dependents.erase(std::remove(dependents.begin(), dependents.end(), sig),
+                     dependents.end());
+  }
+
   virtual std::ostream &displayDependencies(std::ostream &os, const int = -1,
                                             std::string space = "",
                                             std::string next1 = "",
@@ -76,6 +195,16 @@ public:
 
   /// \}
 
+  /// \name Profiling
+  /// \{
+
+  /// Counters of the evaluation of the signal, updated while
+  /// SignalProfile::isEnabled().
+  const SignalProfile &getProfile() const { return profile; }
+  void resetProfile() { profile.reset(); }
+
+  /// \}
+
   /// \name Plug
   /// \{
 
@@ -145,6 +274,43 @@ public:
                              this->getName().c_str());
   }
 
+  /// Return true if the value of the signal is a constant, which is saved
+  /// by the snapshots of the pool (see PoolStorage::writeSnapshot()).
+  virtual bool isConstant() const { return false; }
+
+  /// Write the value of the signal in binary form (see signal_binary_io).
+  virtual void writeValue(std::ostream &) const {
+    DG_THROW ExceptionSignal(ExceptionSignal::SET_IMPOSSIBLE,
+                             "Get operation not possible with this signal. ",
+                             "(while trying to write %s).",
+                             this->getName().c_str());
+  }
+
+  /// Set the signal to the constant value written by writeValue().
+  virtual void readValue(std::istream &) {
+    DG_THROW ExceptionSignal(ExceptionSignal::SET_IMPOSSIBLE,
+                             "Set operation not possible with this signal. ",
+                             "(while trying to read %s).",
+                             this->getName().c_str());
+  }
+
+  /// Description of the records written by traceBinary(), such as float64
+  /// or float64[3x1] (see signal_binary_io::format()).
+  virtual std::string getBinaryTraceFormat() const {
+    DG_THROW ExceptionSignal(ExceptionSignal::SET_IMPOSSIBLE,
+                             "Trace operation not possible with this signal. ",
+                             "(while trying to trace %s).",
+                             this->getName().c_str());
+  }
+
+  /// Write the value of the signal as a record of a binary trace.
+  virtual void traceBinary(std::ostream &) const {
+    DG_THROW ExceptionSignal(ExceptionSignal::SET_IMPOSSIBLE,
+                             "Trace operation not possible with this signal. ",
+                             "(while trying to trace %s).",
+                             this->getName().c_str());
+  }
+
   /// \}
 
   /// \name Display
@@ -155,15 +321,11 @@ public:
     return os;
   }
 
+  /// Name of the signal in its entity: the last part of its name, after
+  /// the last ':'.
   std::string shortName() const {
-    std::istringstream iss(name);
-    const int SIZE = 128;
-    char buffer[SIZE];
-    while (iss.good()) {
-      iss.getline(buffer, SIZE, ':');
-    }
-    const std::string res(buffer);
-    return res;
+    const std::size_t pos = name.rfind(':');
+    return (pos == std::string::npos) ? name : name.substr(pos + 1);
   }
   /// \}
 
@@ -193,12 +355,101 @@ public:
                              "(while trying to plug <%s>).",
                              this->getName().c_str());
   }
+
+  /// Return the address of the value of the signal if it can be read as
+  /// type, or NULL. Unlike checkCompatibility(), it does not throw.
+  virtual void *getCompatibleValue(const std::type_info &) { return NULL; }
+  /// Whether getCompatibleValue() knows all the types the value can be read
+  /// as. Otherwise, checkCompatibility() is tried when it returns NULL.
+  virtual bool knowsCompatibleValues() const { return false; }
+
+  /// Return the address of the value of the signal as a T, or NULL if it
+  /// cannot be read as a T, from getCompatibleValue() or, for the signals
+  /// which do not know all their compatible types, checkCompatibility().
+  template <class T> T *getValueOfType() {
+    T *value = static_cast<T *>(getCompatibleValue(typeid(T)));
+    if (NULL != value || knowsCompatibleValues())
+      return value;
+    try {
+      checkCompatibility();
+    } catch (T *thrown) {
+      return thrown;
+    } catch (...) {
+    }
+    return NULL;
+  }
   /// \}
 
 protected:
+  void incrementVersion() {
+    ++version;
+    newUpdateEpoch();
+  }
+
+  void notifyDependents() {
+    const bool outermost = beginNotification();
+    const typename std::vector<SignalBase<Time> *>::const_iterator itend =
+        dependents.end();
+    for (typename std::vector<SignalBase<Time> *>::const_iterator it =
+             dependents.begin();
+         it != itend; ++it)
+      (*it)->setDirty();
+    endNotification(outermost);
+  }
+
+  /// Start a new propagation of a modification to the dependents, unless
+  /// one is already in progress in the thread, and return true in that
+  /// case. The signals reached through several paths or through a cycle
+  /// compare getNotificationRound() to be notified only once.
+  static bool beginNotification() {
+    unsigned long &round = notificationRound();
+    if (0 != round)
+      return false;
+    round = lastNotificationRound().fetch_add(1, std::memory_order_relaxed) + 1;
+    return true;
+  }
+  static void endNotification(const bool &outermost) {
+    if (outermost)
+      notificationRound() = 0;
+  }
+
   std::string name;
   Time signalTime;
   bool ready;
+  unsigned long version;
+  // Modified through const references, as the dependencies are.
+  mutable std::vector<SignalBase<Time> *> dependents;
+  SignalProfile profile;
+  // The TimeDependency whose leader is this signal, if any.
+  DependencyHolder<Time> *dependencyHolder;
+  friend class TimeDependency<Time>;
+
+private:
+  // Atomic, since signals are modified concurrently by ExecutionPlan.
+  static std::atomic<unsigned long> &updateEpoch() {
+    static std::atomic<unsigned long> epoch(1);
+    return epoch;
+  }
+
+  static bool &updateEpochDeferred() {
+    static thread_local bool deferred = false;
+    return deferred;
+  }
+
+  static unsigned long &notificationRound() {
+    static thread_local unsigned long round = 0;
+    return round;
+  }
+
+  static std::atomic<unsigned long> &lastNotificationRound() {
+    static std::atomic<unsigned long> round(0);
+    return round;
+  }
+
+  static unsigned long &graphRevision() {
+    static unsigned long revision = 0;
+    return revision;
+  }
 };
 
 /// Forward to a virtual fonction.
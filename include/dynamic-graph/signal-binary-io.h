@@ -0,0 +1,194 @@
+// -*- mode: c++ -*-
+// Copyright 2020, LAAS-CNRS
+//
+
+#ifndef DYNAMIC_GRAPH_SIGNAL_BINARY_IO_H
+#define DYNAMIC_GRAPH_SIGNAL_BINARY_IO_H
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+#include <dynamic-graph/exception-signal.h>
+#include <dynamic-graph/linear-algebra.h>
+#include <dynamic-graph/signal-caster.h>
+
+namespace dynamicgraph {
+namespace binary {
+/// \name Raw binary encoding, in the byte order of the machine.
+/// \{
+template <typename T> inline void write(std::ostream &os, const T &value) {
+  os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> inline T read(std::istream &is) {
+  T value;
+  is.read(reinterpret_cast<char *>(&value), sizeof(T));
+  if (is.fail())
+    throw ExceptionSignal(ExceptionSignal::GENERIC,
+                          "unexpected end of binary data");
+  return value;
+}
+
+inline void writeString(std::ostream &os, const std::string &s) {
+  write<std::uint32_t>(os, static_cast<std::uint32_t>(s.size()));
+  os.write(s.data(), static_cast<std::streamsize>(s.size()));
+}
+
+/// Read size bytes into bytes. The sizes come from the data itself: they
+/// are read by chunks, so that a corrupted size fails at the end of the
+/// data instead of allocating the whole size at once.
+inline void readBytes(std::istream &is, std::uint64_t size,
+                      std::string &bytes) {
+  static const std::uint64_t CHUNK_SIZE = 1 << 16;
+  bytes.clear();
+  while (bytes.size() < size) {
+    const std::size_t offset = bytes.size();
+    const std::size_t n =
+        static_cast<std::size_t>(std::min(CHUNK_SIZE, size - offset));
+    bytes.resize(offset + n);
+    is.read(&bytes[offset], static_cast<std::streamsize>(n));
+    if (is.fail())
+      throw ExceptionSignal(ExceptionSignal::GENERIC,
+                            "unexpected end of binary data");
+  }
+}
+
+inline std::string readString(std::istream &is) {
+  std::string s;
+  readBytes(is, read<std::uint32_t>(is), s);
+  return s;
+}
+/// \}
+
+/// Name of the scalar type T in the binary traces: int32, uint8, float64...
+template <typename T> inline std::string scalarName() {
+  std::ostringstream oss;
+  oss << (std::is_floating_point<T>::value
+              ? "float"
+              : (std::is_signed<T>::value ? "int" : "uint"))
+      << 8 * sizeof(T);
+  return oss.str();
+}
+} // namespace binary
+
+/// Binary serialization of the value of a signal, used by the snapshots of
+/// the pool (see PoolStorage::writeSnapshot()). By default, the value is
+/// stored as its text representation, as given by signal_io.
+///
+/// The binary traces (see Tracer::BINARY) describe the values once, by
+/// format(), and then only store their data, by record(): for the types
+/// with a fixed size, such as the scalars and the matrices, each record has
+/// the same size. Records of the default text form are prefixed by their
+/// length.
+template <typename T, typename Enable = void> struct signal_binary_io {
+  inline static void write(const T &value, std::ostream &os) {
+    std::ostringstream oss;
+    signal_io<T>::disp(value, oss);
+    binary::writeString(os, oss.str());
+  }
+  inline static T read(std::istream &is) {
+    std::istringstream iss(binary::readString(is));
+    return signal_io<T>::cast(iss);
+  }
+  inline static std::string format(const T &) { return "text"; }
+  inline static void record(const T &value, std::ostream &os) {
+    std::ostringstream oss;
+    signal_io<T>::trace(value, oss);
+    binary::writeString(os, oss.str());
+  }
+};
+
+/// Template specialization of signal_binary_io for the arithmetic types.
+template <typename T>
+struct signal_binary_io<
+    T, typename std::enable_if<std::is_arithmetic<T>::value>::type> {
+  inline static void write(const T &value, std::ostream &os) {
+    binary::write(os, value);
+  }
+  inline static T read(std::istream &is) { return binary::read<T>(is); }
+  inline static std::string format(const T &) {
+    return binary::scalarName<T>();
+  }
+  inline static void record(const T &value, std::ostream &os) {
+    binary::write(os, value);
+  }
+};
+
+/// Template specialization of signal_binary_io for strings.
+template <> struct signal_binary_io<std::string> {
+  inline static void write(const std::string &value, std::ostream &os) {
+    binary::writeString(os, value);
+  }
+  inline static std::string read(std::istream &is) {
+    return binary::readString(is);
+  }
+  inline static std::string format(const std::string &) { return "text"; }
+  inline static void record(const std::string &value, std::ostream &os) {
+    binary::writeString(os, value);
+  }
+};
+
+/// Template specialization of signal_binary_io for Eigen objects: their
+/// size, followed by their coefficients. In the traces, the size is part of
+/// the format, as in float64[3x1], and the records only hold the
+/// coefficients, in the storage order of the matrix.
+template <typename _Scalar, int _Rows, int _Cols, int _Options, int _MaxRows,
+          int _MaxCols>
+struct signal_binary_io<
+    Eigen::Matrix<_Scalar, _Rows, _Cols, _Options, _MaxRows, _MaxCols>> {
+  typedef Eigen::Matrix<_Scalar, _Rows, _Cols, _Options, _MaxRows, _MaxCols>
+      matrix_type;
+
+  inline static void write(const matrix_type &value, std::ostream &os) {
+    binary::write<std::uint32_t>(os, static_cast<std::uint32_t>(value.rows()));
+    binary::write<std::uint32_t>(os, static_cast<std::uint32_t>(value.cols()));
+    os.write(reinterpret_cast<const char *>(value.data()),
+             static_cast<std::streamsize>(value.size() * sizeof(_Scalar)));
+  }
+  inline static matrix_type read(std::istream &is) {
+    // Number of coefficients of which the size in bytes fits in an index.
+    static const std::uint64_t MAX_SIZE =
+        std::uint64_t(
+            std::numeric_limits<EIGEN_DEFAULT_DENSE_INDEX_TYPE>::max()) /
+        sizeof(_Scalar);
+    const std::uint32_t rows = binary::read<std::uint32_t>(is);
+    const std::uint32_t cols = binary::read<std::uint32_t>(is);
+    if ((_Rows != Eigen::Dynamic && rows != std::uint32_t(_Rows)) ||
+        (_Cols != Eigen::Dynamic && cols != std::uint32_t(_Cols)) ||
+        (_MaxRows != Eigen::Dynamic && rows > std::uint32_t(_MaxRows)) ||
+        (_MaxCols != Eigen::Dynamic && cols > std::uint32_t(_MaxCols)) ||
+        (0 != cols && std::uint64_t(rows) > MAX_SIZE / cols))
+      throw ExceptionSignal(ExceptionSignal::GENERIC,
+                            "invalid size of matrix in binary data",
+                            " (%ux%u).", rows, cols);
+    // The coefficients are read before allocating the matrix, see
+    // binary::readBytes().
+    std::string bytes;
+    binary::readBytes(is, std::uint64_t(rows) * cols * sizeof(_Scalar), bytes);
+    matrix_type value;
+    value.resize(rows, cols);
+    if (!bytes.empty())
+      std::memcpy(value.data(), bytes.data(), bytes.size());
+    return value;
+  }
+  inline static std::string format(const matrix_type &value) {
+    std::ostringstream oss;
+    oss << binary::scalarName<_Scalar>() << "[" << value.rows() << "x"
+        << value.cols() << "]";
+    return oss.str();
+  }
+  inline static void record(const matrix_type &value, std::ostream &os) {
+    os.write(reinterpret_cast<const char *>(value.data()),
+             static_cast<std::streamsize>(value.size() * sizeof(_Scalar)));
+  }
+};
+
+} // end of namespace dynamicgraph
+
+#endif //! DYNAMIC_GRAPH_SIGNAL_BINARY_IO_H
@@ -0,0 +1,66 @@
+// -*- mode: c++ -*-
+// Copyright 2020, LAAS-CNRS
+//
+
+#ifndef DYNAMIC_GRAPH_SIGNAL_COMPATIBILITY_H
+#define DYNAMIC_GRAPH_SIGNAL_COMPATIBILITY_H
+#include <map>
+#include <mutex>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+
+#include <boost/noncopyable.hpp>
+
+#include <dynamic-graph/dynamic-graph-api.h>
+
+namespace dynamicgraph {
+/// \ingroup dgraph
+///
+/// \brief Registry of the conversions between the types of the values of
+/// the signals, keyed by the pair of types.
+///
+/// A Signal<T> gives its value to the ports of type T, and to the ports of
+/// the types to which T has a registered conversion (see
+/// Signal::getCompatibleValue()), without throwing. For instance, the value
+/// of a signal of a derived class is read through a port of its base class
+/// without going through Signal::checkCompatibility() once
+/// registerConversion<Derived, Base>() has been called.
+class DYNAMIC_GRAPH_DLLAPI SignalCompatibility : private boost::noncopyable {
+public:
+  /// Give the address of a value of the target type from the address of a
+  /// value of the source type.
+  typedef void *(*Conversion)(void *);
+
+  static SignalCompatibility &getInstance();
+
+  void registerConversion(const std::type_info &source,
+                          const std::type_info &target,
+                          Conversion conversion);
+  /// Register the conversion of a pointer to Source into a pointer to
+  /// Target, such as a derived class into its base class.
+  template <class Source, class Target> void registerConversion() {
+    registerConversion(typeid(Source), typeid(Target),
+                       &SignalCompatibility::convert<Source, Target>);
+  }
+
+  /// Return the conversion from source to target, or NULL if there is
+  /// none.
+  Conversion getConversion(const std::type_info &source,
+                           const std::type_info &target) const;
+
+private:
+  SignalCompatibility() {}
+
+  template <class Source, class Target> static void *convert(void *value) {
+    return static_cast<Target *>(static_cast<Source *>(value));
+  }
+
+  typedef std::pair<std::type_index, std::type_index> Key;
+  std::map<Key, Conversion> conversions;
+  mutable std::mutex mutex;
+};
+
+} // end of namespace dynamicgraph
+
+#endif //! DYNAMIC_GRAPH_SIGNAL_COMPATIBILITY_H
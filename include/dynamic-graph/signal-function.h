@@ -0,0 +1,74 @@
+// -*- mode: c++ -*-
+// Copyright 2020, LAAS-CNRS
+//
+
+#ifndef DYNAMIC_GRAPH_SIGNAL_FUNCTION_H
+#define DYNAMIC_GRAPH_SIGNAL_FUNCTION_H
+#include <cstddef>
+
+namespace dynamicgraph {
+/// \ingroup dgraph
+///
+/// \brief Non-owning callable computing the value of a signal.
+///
+/// Unlike boost::function2, it never allocates and holds only an object
+/// pointer and the address of a stub. The bound method or function is a
+/// template parameter of the stub, so that it is called directly (and can
+/// be inlined) instead of going through a bound member function pointer.
+///
+/// The object must outlive the signal, which is the case of the methods of
+/// an entity used to compute its own signals. Use makeSignalFunction(), or
+/// the SIGNAL_FUNCTION macro to deduce the type of the method.
+template <class T, class Time> class SignalFunction {
+public:
+  typedef T &(*Stub)(void *object, T &res, const Time &t);
+
+  SignalFunction() : object(NULL), stub(NULL) {}
+  SignalFunction(void *object, Stub stub) : object(object), stub(stub) {}
+
+  T &operator()(T &res, const Time &t) const { return stub(object, res, t); }
+
+  bool empty() const { return NULL == stub; }
+
+private:
+  void *object;
+  Stub stub;
+};
+
+namespace internal {
+template <class T, class Time, class C, class Method, Method method>
+T &callMethod(void *object, T &res, const Time &t) {
+  return (static_cast<C *>(object)->*method)(res, t);
+}
+
+template <class T, class Time, class Function, Function function>
+T &callFunction(void *, T &res, const Time &t) {
+  return function(res, t);
+}
+} // namespace internal
+
+/// Bind method of object, e.g.
+/// makeSignalFunction<Vector, int, Entity, Vector &(Entity::*)(Vector &, int),
+///                    &Entity::compute>(this)
+template <class T, class Time, class C, class Method, Method method>
+SignalFunction<T, Time> makeSignalFunction(C *object) {
+  return SignalFunction<T, Time>(
+      object, &internal::callMethod<T, Time, C, Method, method>);
+}
+
+/// Bind a free function.
+template <class T, class Time, class Function, Function function>
+SignalFunction<T, Time> makeSignalFunction() {
+  return SignalFunction<T, Time>(
+      NULL, &internal::callFunction<T, Time, Function, function>);
+}
+
+} // end of namespace dynamicgraph
+
+/// Bind method of object in a SignalFunction<T, Time>, e.g.
+/// SIGNAL_FUNCTION(Vector, int, Entity, compute, this)
+#define SIGNAL_FUNCTION(T, Time, C, method, object)                            \
+  ::dynamicgraph::makeSignalFunction<T, Time, C, decltype(&C::method),         \
+                                     &C::method>(object)
+
+#endif //! DYNAMIC_GRAPH_SIGNAL_FUNCTION_H
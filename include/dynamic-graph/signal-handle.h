@@ -0,0 +1,59 @@
+// -*- mode: c++ -*-
+// Copyright 2020, LAAS-CNRS
+//
+
+#ifndef DYNAMIC_GRAPH_SIGNAL_HANDLE_H
+#define DYNAMIC_GRAPH_SIGNAL_HANDLE_H
+#include <string>
+
+#include <dynamic-graph/dynamic-graph-api.h>
+#include <dynamic-graph/fwd.hh>
+#include <dynamic-graph/pool.h>
+#include <dynamic-graph/signal-base.h>
+
+namespace dynamicgraph {
+/// \ingroup dgraph
+///
+/// \brief Reference to a signal of the pool by its path "entity.signal",
+/// looked up once and then dereferenced at the cost of a comparison.
+///
+/// The signal is looked up again when an entity or a signal has been
+/// registered or deregistered since (see
+/// PoolStorage::getRegistryRevision()), so that the handle follows the
+/// signal registered under its path.
+class DYNAMIC_GRAPH_DLLAPI SignalHandle {
+public:
+  SignalHandle() : signal(NULL), revision(0) {}
+  /// \param path string of the form "entity.signal"
+  explicit SignalHandle(const std::string &path);
+  SignalHandle(const std::string &entityName, const std::string &signalName);
+
+  const std::string &getEntityName() const { return entityName; }
+  const std::string &getSignalName() const { return signalName; }
+
+  /// Return true if the signal exists.
+  bool isValid() const;
+
+  /// Return the signal.
+  /// \throw ExceptionFactory if it does not exist.
+  SignalBase<int> &get() const {
+    if (revision != PoolStorage::getRegistryRevision())
+      resolve();
+    return *signal;
+  }
+  SignalBase<int> &operator*() const { return get(); }
+  SignalBase<int> *operator->() const { return &get(); }
+
+private:
+  void resolve() const;
+
+  std::string entityName;
+  std::string signalName;
+  mutable SignalBase<int> *signal;
+  // Registry revision at which signal has been looked up.
+  mutable unsigned long revision;
+};
+
+} // end of namespace dynamicgraph
+
+#endif //! DYNAMIC_GRAPH_SIGNAL_HANDLE_H
@@ -25,8 +25,8 @@
   m_##name##S##IO(getClassName() + "(" + getName() + ")::" + #IO + "put(" +    \
                   #type + ")::" + #name)
 #define BIND_SIGNAL_TO_FUNCTION(name, IO, type)                                \
-  m_##name##S##IO.setFunction(boost::bind(                                     \
-      &EntityClassName::SIGNAL_OUT_FUNCTION_NAME(name), this, _1, _2));
+  m_##name##S##IO.setFunction(SIGNAL_FUNCTION(                                 \
+      type, int, EntityClassName, SIGNAL_OUT_FUNCTION_NAME(name), this));
 
 /**/
 
@@ -55,7 +55,8 @@ protected:                                                                     \
 
 #define CONSTRUCT_SIGNAL_OUT(name, type, dep)                                  \
   m_##name##SOUT(                                                              \
-      boost::bind(&EntityClassName::name##SOUT_function, this, _1, _2), dep,   \
+      SIGNAL_FUNCTION(type, int, EntityClassName, name##SOUT_function, this),  \
+      dep,                                                                     \
       getClassName() + "(" + getName() + ")::output(" + #type + ")::" + #name)
 
 /**************** INNER SIGNALS *******************/
@@ -76,7 +77,9 @@ protected:                                                                     \
 
 #define CONSTRUCT_SIGNAL_INNER(name, type, dep)                                \
   m_##name##SINNER(                                                            \
-      boost::bind(&EntityClassName::name##SINNER_function, this, _1, _2), dep, \
+      SIGNAL_FUNCTION(type, int, EntityClassName, name##SINNER_function,       \
+                      this),                                                   \
+      dep,                                                                     \
       getClassName() + "(" + getName() + ")::inner(" + #type + ")::" + #name)
 
 #endif // __dynamic_graph_signal_helper_H__
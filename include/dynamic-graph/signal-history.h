@@ -0,0 +1,71 @@
+// -*- mode: c++ -*-
+// Copyright 2020, LAAS-CNRS
+//
+
+#ifndef DYNAMIC_GRAPH_SIGNAL_HISTORY_H
+#define DYNAMIC_GRAPH_SIGNAL_HISTORY_H
+#include <cstddef>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace dynamicgraph {
+/// \ingroup dgraph
+///
+/// \brief Ring buffer of the last values of a signal and of their times.
+///
+/// All the values are allocated by the constructor, as copies of an
+/// initial value: recording a value then only assigns an existing one,
+/// which does not allocate memory as long as the values keep the same
+/// size.
+template <class T, class Time>
+class SignalHistory : private boost::noncopyable {
+public:
+  SignalHistory(const std::size_t depth, const T &init)
+      : values(depth, init), times(depth), head(0), count(0) {}
+
+  std::size_t getDepth() const { return values.size(); }
+
+  /// Number of values recorded, at most getDepth().
+  std::size_t getSize() const { return count; }
+
+  void record(const T &value, const Time &t) {
+    head = (head + 1) % values.size();
+    values[head] = value;
+    times[head] = t;
+    if (count < values.size())
+      ++count;
+  }
+
+  void clear() { count = 0; }
+
+  /// Value recorded k values ago, 0 being the latest one.
+  /// \pre k < getSize()
+  const T &getValue(const std::size_t k) const { return values[index(k)]; }
+  const Time &getTime(const std::size_t k) const { return times[index(k)]; }
+
+  /// Find the latest value recorded at or before t.
+  /// \return the number of values recorded since, or getSize() if all the
+  /// recorded values are more recent than t.
+  std::size_t find(const Time &t) const {
+    std::size_t k = 0;
+    while (k < count && t < times[index(k)])
+      ++k;
+    return k;
+  }
+
+private:
+  std::size_t index(const std::size_t k) const {
+    return (head + values.size() - k) % values.size();
+  }
+
+  std::vector<T> values;
+  std::vector<Time> times;
+  // Index of the latest value.
+  std::size_t head;
+  std::size_t count;
+};
+
+} // end of namespace dynamicgraph
+
+#endif //! DYNAMIC_GRAPH_SIGNAL_HISTORY_H
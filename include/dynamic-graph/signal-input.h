@@ -0,0 +1,123 @@
+// -*- mode: c++ -*-
+// Copyright 2020, LAAS-CNRS
+//
+
+#ifndef DYNAMIC_GRAPH_SIGNAL_INPUT_H
+#define DYNAMIC_GRAPH_SIGNAL_INPUT_H
+
+#include <dynamic-graph/exception-signal.h>
+#include <dynamic-graph/signal-base.h>
+#include <dynamic-graph/signal.h>
+
+namespace dynamicgraph {
+/// \ingroup dgraph
+///
+/// \brief Input of an entity, to be plugged to the signal providing its
+/// value, as a SignalPtr.
+///
+/// Unlike SignalPtr, which is a Signal<T, Time>, the input does not hold
+/// any value of type T: when it is plugged, it is only a pointer on the
+/// plugged signal. The value of the input is only stored when the input is
+/// set to a constant (see setConstant() and setConstantDefault()), in a
+/// Signal<T, Time> allocated at that time. This saves the memory of two
+/// copies of T for each input of large types.
+///
+/// As for SignalPtr, a signal which is not a Signal<T, Time> can be
+/// plugged if its value is of type T (see
+/// SignalBase::getCompatibleValue()).
+template <class T, class Time> class SignalInput : public SignalBase<Time> {
+public:
+  using SignalBase<Time>::getName;
+
+protected:
+  // Signal plugged, NULL if none.
+  SignalBase<Time> *source;
+  // Same signal, when its value is accessed through its type.
+  Signal<T, Time> *signalPtr;
+  SignalInput<T, Time> *inputPtr;
+  // Value of the plugged signal otherwise.
+  const T *abstractData;
+  // Constant value, allocated by setConstant() or setConstantDefault().
+  Signal<T, Time> *storage;
+  bool modeNoThrow;
+
+  Signal<T, Time> &getStorage();
+  void release();
+
+public: /* --- CONSTRUCTORS --- */
+  explicit SignalInput(std::string name = "")
+      : SignalBase<Time>(name), source(NULL), signalPtr(NULL), inputPtr(NULL),
+        abstractData(NULL), storage(NULL), modeNoThrow(false) {}
+
+  virtual ~SignalInput() {
+    release();
+    delete storage;
+  }
+
+public: /* --- PLUG-IN OPERATION --- */
+  virtual void plug(SignalBase<Time> *ref);
+  virtual void unplug() { plug(NULL); }
+  virtual bool isPlugged() const { return NULL != source; }
+  virtual SignalBase<Time> *getPluged() const { return source; }
+
+  /// Plugged signal, if it is a Signal<T, Time>.
+  Signal<T, Time> *getPtr() const;          // throw
+  SignalBase<Time> *getAbstractPtr() const; // throw
+
+  inline operator bool() const { return isPlugged(); }
+
+public: /* --- VALUE --- */
+  const T &access(const Time &t);
+  inline const T &operator()(const Time &t) { return access(t); }
+  const T &accessCopy() const;
+
+  /// Plug the input to a constant value, as SignalPtr::setConstant().
+  void setConstant(const T &t);
+  inline SignalInput<T, Time> &operator=(const T &t) {
+    setConstant(t);
+    return *this;
+  }
+
+  /// Value returned while the input is not plugged.
+  void setConstantDefault(const T &t);
+  virtual inline void setConstantDefault() { setConstantDefault(accessCopy()); }
+  inline void unsetConstantDefault() { modeNoThrow = false; }
+
+public: /* --- INHERITANCE --- */
+  virtual const Time &getTime() const;
+  virtual bool needUpdate(const Time &t) const;
+  virtual void
+  collectDependencies(std::vector<const SignalBase<Time> *> &deps) const;
+  virtual bool isForwarder() const { return true; }
+  virtual bool pushesUpdates() const;
+  virtual void dependencyDestroyed(const SignalBase<Time> &sig);
+
+  virtual void set(std::istringstream &value);
+  virtual void get(std::ostream &os) const;
+  virtual void recompute(const Time &t) { access(t); }
+  virtual void trace(std::ostream &os) const;
+  virtual bool isConstant() const {
+    return NULL != source && source == storage;
+  }
+  virtual void writeValue(std::ostream &os) const;
+  virtual void readValue(std::istream &is);
+  virtual std::string getBinaryTraceFormat() const;
+  virtual void traceBinary(std::ostream &os) const;
+
+  virtual void checkCompatibility();
+  virtual void *getCompatibleValue(const std::type_info &type);
+  virtual bool knowsCompatibleValues() const;
+
+  virtual std::ostream &writeGraph(std::ostream &os) const;
+  virtual std::ostream &display(std::ostream &os) const;
+  virtual std::ostream &displayDependencies(std::ostream &os,
+                                            const int depth = -1,
+                                            std::string space = "",
+                                            std::string next1 = "",
+                                            std::string next2 = "") const;
+};
+
+} // end of namespace dynamicgraph
+
+#include <dynamic-graph/signal-input.t.cpp>
+#endif //! DYNAMIC_GRAPH_SIGNAL_INPUT_H
@@ -0,0 +1,280 @@
+// -*- mode: c++ -*-
+// Copyright 2020, LAAS-CNRS
+//
+
+#ifndef DYNAMIC_GRAPH_SIGNAL_INPUT_T_CPP
+#define DYNAMIC_GRAPH_SIGNAL_INPUT_T_CPP
+#include <dynamic-graph/signal-input.h>
+
+namespace dynamicgraph {
+
+template <class T, class Time>
+Signal<T, Time> &SignalInput<T, Time>::getStorage() {
+  if (NULL == storage)
+    storage = new Signal<T, Time>(getName());
+  return *storage;
+}
+
+template <class T, class Time> void SignalInput<T, Time>::release() {
+  if (NULL != source)
+    source->removeDependent(this);
+  source = NULL;
+  signalPtr = NULL;
+  inputPtr = NULL;
+  abstractData = NULL;
+}
+
+template <class T, class Time>
+void SignalInput<T, Time>::plug(SignalBase<Time> *ref) {
+  if (NULL == ref) {
+    release();
+    SignalBase<Time>::invalidateGraph();
+    this->setDirty();
+    return;
+  }
+
+  if (ref == this)
+    DG_THROW ExceptionSignal(ExceptionSignal::PLUG_IMPOSSIBLE,
+                             "An input cannot be plugged on itself.",
+                             "(while trying to plug <%s>).", getName().c_str());
+
+  Signal<T, Time> *sig = dynamic_cast<Signal<T, Time> *>(ref);
+  SignalInput<T, Time> *input = dynamic_cast<SignalInput<T, Time> *>(ref);
+  const T *data = NULL;
+  if (NULL == sig && NULL == input) {
+    data = ref->template getValueOfType<T>();
+    if (NULL == data)
+      DG_THROW ExceptionSignal(ExceptionSignal::PLUG_IMPOSSIBLE,
+                               "Compl. Uncompatible types for plugin.",
+                               "(while trying to plug <%s> on <%s>)"
+                               " with types <%s> on <%s>.",
+                               ref->getName().c_str(), getName().c_str(),
+                               typeid(T).name(), typeid(ref).name());
+  }
+
+  release();
+  source = ref;
+  signalPtr = sig;
+  inputPtr = input;
+  abstractData = data;
+  source->addDependent(this);
+  SignalBase<Time>::invalidateGraph();
+  // The value read by the dependents has changed.
+  this->setDirty();
+}
+
+template <class T, class Time>
+Signal<T, Time> *SignalInput<T, Time>::getPtr() const {
+  if (NULL == signalPtr)
+    DG_THROW ExceptionSignal(ExceptionSignal::NOT_INITIALIZED,
+                             "In SignalInput: SIN ptr not set.",
+                             " (in signal <%s>)", getName().c_str());
+  return signalPtr;
+}
+
+template <class T, class Time>
+SignalBase<Time> *SignalInput<T, Time>::getAbstractPtr() const {
+  if (NULL == source)
+    DG_THROW ExceptionSignal(ExceptionSignal::NOT_INITIALIZED,
+                             "In SignalInput: SIN ptr not set.",
+                             " (in signal <%s>)", getName().c_str());
+  return source;
+}
+
+template <class T, class Time>
+const T &SignalInput<T, Time>::access(const Time &t) {
+  if (NULL != signalPtr)
+    return signalPtr->access(t);
+  if (NULL != inputPtr)
+    return inputPtr->access(t);
+  if (NULL != source) {
+    source->recompute(t);
+    return *abstractData;
+  }
+  if (modeNoThrow && NULL != storage)
+    return storage->accessCopy();
+  DG_THROW ExceptionSignal(ExceptionSignal::NOT_INITIALIZED,
+                           "In SignalInput: SIN ptr not set.",
+                           " (in signal <%s>)", getName().c_str());
+}
+
+template <class T, class Time>
+const T &SignalInput<T, Time>::accessCopy() const {
+  if (NULL != signalPtr)
+    return signalPtr->accessCopy();
+  if (NULL != inputPtr)
+    return inputPtr->accessCopy();
+  if (NULL != source)
+    return *abstractData;
+  if (modeNoThrow && NULL != storage)
+    return storage->accessCopy();
+  DG_THROW ExceptionSignal(ExceptionSignal::NOT_INITIALIZED,
+                           "In SignalInput: SIN ptr not set.",
+                           " (in signal <%s>)", getName().c_str());
+}
+
+template <class T, class Time>
+void SignalInput<T, Time>::setConstant(const T &t) {
+  Signal<T, Time> &cst = getStorage();
+  cst.setConstant(t);
+  if (source != &cst)
+    plug(&cst);
+}
+
+template <class T, class Time>
+void SignalInput<T, Time>::setConstantDefault(const T &t) {
+  // The value may be the one of the storage.
+  const T value(t);
+  getStorage().setConstant(value);
+  modeNoThrow = true;
+}
+
+template <class T, class Time>
+const Time &SignalInput<T, Time>::getTime() const {
+  if (NULL != source)
+    return source->getTime();
+  return SignalBase<Time>::getTime();
+}
+
+template <class T, class Time>
+bool SignalInput<T, Time>::needUpdate(const Time &t) const {
+  if (NULL != source)
+    return source->needUpdate(t);
+  return false;
+}
+
+template <class T, class Time>
+void SignalInput<T, Time>::collectDependencies(
+    std::vector<const SignalBase<Time> *> &deps) const {
+  if (NULL != source)
+    deps.push_back(source);
+}
+
+template <class T, class Time>
+bool SignalInput<T, Time>::pushesUpdates() const {
+  if (NULL != source)
+    return source->pushesUpdates();
+  return false;
+}
+
+template <class T, class Time>
+void SignalInput<T, Time>::dependencyDestroyed(const SignalBase<Time> &sig) {
+  if (&sig == source)
+    plug(NULL);
+}
+
+template <class T, class Time>
+void SignalInput<T, Time>::set(std::istringstream &value) {
+  setConstant(signal_io<T>::cast(value));
+}
+
+template <class T, class Time>
+void SignalInput<T, Time>::get(std::ostream &os) const {
+  signal_io<T>::disp(accessCopy(), os);
+}
+
+template <class T, class Time>
+void SignalInput<T, Time>::trace(std::ostream &os) const {
+  try {
+    signal_io<T>::trace(accessCopy(), os);
+  } catch DG_RETHROW catch (...) {
+    DG_THROW ExceptionSignal(ExceptionSignal::SET_IMPOSSIBLE,
+                             "TRACE operation not possible with this signal. ",
+                             "(bad cast while getting value from %s).",
+                             getName().c_str());
+  }
+}
+
+template <class T, class Time>
+void SignalInput<T, Time>::writeValue(std::ostream &os) const {
+  signal_binary_io<T>::write(accessCopy(), os);
+}
+
+template <class T, class Time>
+void SignalInput<T, Time>::readValue(std::istream &is) {
+  setConstant(signal_binary_io<T>::read(is));
+}
+
+template <class T, class Time>
+std::string SignalInput<T, Time>::getBinaryTraceFormat() const {
+  return signal_binary_io<T>::format(accessCopy());
+}
+
+template <class T, class Time>
+void SignalInput<T, Time>::traceBinary(std::ostream &os) const {
+  signal_binary_io<T>::record(accessCopy(), os);
+}
+
+template <class T, class Time> void SignalInput<T, Time>::checkCompatibility() {
+  if (NULL != source)
+    source->checkCompatibility();
+  else if (modeNoThrow && NULL != storage)
+    storage->checkCompatibility();
+  else
+    SignalBase<Time>::checkCompatibility();
+}
+
+template <class T, class Time>
+void *SignalInput<T, Time>::getCompatibleValue(const std::type_info &type) {
+  if (NULL != source)
+    return source->getCompatibleValue(type);
+  if (modeNoThrow && NULL != storage)
+    return storage->getCompatibleValue(type);
+  return NULL;
+}
+
+template <class T, class Time>
+bool SignalInput<T, Time>::knowsCompatibleValues() const {
+  if (NULL != source)
+    return source->knowsCompatibleValues();
+  if (modeNoThrow && NULL != storage)
+    return storage->knowsCompatibleValues();
+  // Not compatible with anything.
+  return true;
+}
+
+template <class T, class Time>
+std::ostream &SignalInput<T, Time>::writeGraph(std::ostream &os) const {
+  if (NULL != source && source != storage) {
+    std::string LeaderLocalName, LeaderNodeName;
+    this->ExtractNodeAndLocalNames(LeaderLocalName, LeaderNodeName);
+    std::string itLocalName, itNodeName;
+    source->ExtractNodeAndLocalNames(itLocalName, itNodeName);
+    os << "\t\"" << itNodeName << "\" -> \"" << LeaderNodeName << "\""
+       << std::endl
+       << "\t [ headlabel = \"" << LeaderLocalName << "\" , taillabel = \""
+       << itLocalName << "\", fontsize=7, fontcolor=red ]" << std::endl;
+  }
+  return os;
+}
+
+template <class T, class Time>
+std::ostream &SignalInput<T, Time>::display(std::ostream &os) const {
+  SignalBase<Time>::display(os);
+  if (NULL == source)
+    os << " UNPLUGGED";
+  else if (source == storage)
+    os << " CONSTANT";
+  else
+    os << " -->-- PLUGGED";
+  return os;
+}
+
+template <class T, class Time>
+std::ostream &
+SignalInput<T, Time>::displayDependencies(std::ostream &os, const int depth,
+                                          std::string space, std::string next1,
+                                          std::string next2) const {
+  if (NULL != source && source != storage) {
+    source->displayDependencies(
+        os, depth, space, next1 + "-- " + SignalBase<Time>::name + " -->",
+        next2);
+  } else {
+    SignalBase<Time>::displayDependencies(os, depth, space, next1, next2);
+  }
+  return os;
+}
+
+} // end of namespace dynamicgraph.
+
+#endif //! DYNAMIC_GRAPH_SIGNAL_INPUT_T_CPP
@@ -0,0 +1,146 @@
+// -*- mode: c++ -*-
+// Copyright 2020, LAAS-CNRS
+//
+
+#ifndef DYNAMIC_GRAPH_SIGNAL_PROFILE_H
+#define DYNAMIC_GRAPH_SIGNAL_PROFILE_H
+#include <atomic>
+#include <chrono>
+#include <ostream>
+
+#include <boost/noncopyable.hpp>
+
+namespace dynamicgraph {
+/// \ingroup dgraph
+///
+/// \brief Counters of the evaluation of a signal, to find the signals
+/// which use most of the time of a tick (see SignalBase::getProfile() and
+/// PoolStorage::writeProfile()).
+///
+/// The counters are only updated while the profiling is enabled: the cost
+/// on the evaluation of a signal is otherwise the test of a flag. The time
+/// spent in the function of the signal can be measured on one computation
+/// out of N only (see setSamplingPeriod()), the clock being read twice for
+/// each measure.
+///
+/// The counters are atomic, since a signal shared by several signals may be
+/// accessed from several threads by the ExecutionPlan.
+class SignalProfile : private boost::noncopyable {
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  SignalProfile()
+      : nbCalls(0), nbRecomputes(0), nbCacheHits(0), nbTimed(0), totalTime(0),
+        maxTime(0), lastTime(0) {}
+
+  /// \name Global settings
+  /// \{
+  static void enable(const bool &b = true) {
+    enabled().store(b, std::memory_order_relaxed);
+  }
+  static bool isEnabled() { return enabled().load(std::memory_order_relaxed); }
+
+  /// Measure the time of one computation out of period, 1 measuring all of
+  /// them and 0 none.
+  static void setSamplingPeriod(const unsigned long &period) {
+    samplingPeriod().store(period, std::memory_order_relaxed);
+  }
+  static unsigned long getSamplingPeriod() {
+    return samplingPeriod().load(std::memory_order_relaxed);
+  }
+  /// \}
+
+  /// \name Recording
+  /// \{
+  void countCall() {
+    if (isEnabled())
+      nbCalls.fetch_add(1, std::memory_order_relaxed);
+  }
+  void countCacheHit() {
+    if (isEnabled())
+      nbCacheHits.fetch_add(1, std::memory_order_relaxed);
+  }
+  /// Count a computation of the value.
+  /// \return true if its duration must be measured.
+  bool countRecompute() {
+    if (!isEnabled())
+      return false;
+    const unsigned long n =
+        nbRecomputes.fetch_add(1, std::memory_order_relaxed);
+    const unsigned long period = getSamplingPeriod();
+    return 0 != period && 0 == n % period;
+  }
+  void addTime(const Clock::duration &d) {
+    const unsigned long long ns = static_cast<unsigned long long>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+    nbTimed.fetch_add(1, std::memory_order_relaxed);
+    totalTime.fetch_add(ns, std::memory_order_relaxed);
+    lastTime.store(ns, std::memory_order_relaxed);
+    unsigned long long max = maxTime.load(std::memory_order_relaxed);
+    while (ns > max &&
+           !maxTime.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+      ;
+  }
+  /// \}
+
+  /// \name Results
+  /// \{
+  /// Number of accesses to the value.
+  unsigned long getNbCalls() const { return nbCalls.load(); }
+  /// Number of computations of the value by the function of the signal.
+  unsigned long getNbRecomputes() const { return nbRecomputes.load(); }
+  /// Number of accesses which returned the value already computed.
+  unsigned long getNbCacheHits() const { return nbCacheHits.load(); }
+  /// Number of computations whose duration has been measured.
+  unsigned long getNbTimed() const { return nbTimed.load(); }
+  /// Total and maximal durations of the measured computations, in seconds.
+  double getTotalTime() const { return 1e-9 * double(totalTime.load()); }
+  double getMaxTime() const { return 1e-9 * double(maxTime.load()); }
+  /// Duration of the last measured computation, in seconds.
+  double getLastTime() const { return 1e-9 * double(lastTime.load()); }
+  double getMeanTime() const {
+    const unsigned long n = getNbTimed();
+    return (0 == n) ? 0. : getTotalTime() / double(n);
+  }
+
+  void reset() {
+    nbCalls = 0;
+    nbRecomputes = 0;
+    nbCacheHits = 0;
+    nbTimed = 0;
+    totalTime = 0;
+    maxTime = 0;
+    lastTime = 0;
+  }
+
+  std::ostream &display(std::ostream &os) const {
+    return os << "calls=" << getNbCalls() << " recomputes=" << getNbRecomputes()
+              << " cacheHits=" << getNbCacheHits() << " timed=" << getNbTimed()
+              << " total=" << getTotalTime() << "s mean=" << getMeanTime()
+              << "s max=" << getMaxTime() << "s";
+  }
+  /// \}
+
+private:
+  static std::atomic<bool> &enabled() {
+    static std::atomic<bool> value(false);
+    return value;
+  }
+  static std::atomic<unsigned long> &samplingPeriod() {
+    static std::atomic<unsigned long> value(1);
+    return value;
+  }
+
+  std::atomic<unsigned long> nbCalls;
+  std::atomic<unsigned long> nbRecomputes;
+  std::atomic<unsigned long> nbCacheHits;
+  std::atomic<unsigned long> nbTimed;
+  // In nanoseconds.
+  std::atomic<unsigned long long> totalTime;
+  std::atomic<unsigned long long> maxTime;
+  std::atomic<unsigned long long> lastTime;
+};
+
+} // end of namespace dynamicgraph
+
+#endif //! DYNAMIC_GRAPH_SIGNAL_PROFILE_H
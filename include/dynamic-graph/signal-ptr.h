@@ -36,15 +36,37 @@ protected:
   bool transmitAbstract;
   SignalBase<Time> *abstractTransmitter;
   T *transmitAbstractData;
+  // Signal notifying this one of its modifications (see setDirty()).
+  SignalBase<Time> *notifier;
+  // End of the chain of SignalPtr plugged on each other, whose value is
+  // read directly (see resolve()).
+  Signal<T, Time> *resolved;
 
   inline bool autoref() const { return signalPtr == this; }
+  // Signal whose value is forwarded, NULL if none.
+  SignalBase<Time> *getForwarded() const {
+    if (autoref())
+      return NULL;
+    return transmitAbstract ? abstractTransmitter : signalPtr;
+  }
+  void updateNotifier();
+  // Update resolved, and the SignalPtr plugged on this one.
+  void resolve();
 
 public: /* --- CONSTRUCTORS --- */
   SignalPtr(Signal<T, Time> *ptr, std::string name = "")
       : Signal<T, Time>(name), signalPtr(ptr), modeNoThrow(false),
-        transmitAbstract(false), abstractTransmitter(NULL) {}
+        transmitAbstract(false), abstractTransmitter(NULL), notifier(NULL),
+        resolved(NULL) {
+    updateNotifier();
+    resolve();
+  }
 
-  virtual ~SignalPtr() { signalPtr = NULL; }
+  virtual ~SignalPtr() {
+    signalPtr = NULL;
+    if (NULL != notifier)
+      notifier->removeDependent(this);
+  }
 
 public:
   /* --- PLUG-IN OPERATION --- */
@@ -59,6 +81,10 @@ public:
   virtual bool isPlugged() const { return (NULL != signalPtr); }
   virtual SignalBase<Time> *getPluged() const { return signalPtr; }
   virtual bool isAbstractPluged() const;
+  /// Signal providing the value, at the end of the chain of SignalPtr
+  /// plugged on each other. NULL if the value is not read from a plugged
+  /// Signal<T, Time>.
+  const Signal<T, Time> *getResolvedPtr() const { return resolved; }
   virtual const Time &getTime() const;
 
   /* Equivalent operator-like definitions. */
@@ -70,6 +96,14 @@ public:
 
 public: /* --- INHERITANCE --- */
   virtual bool needUpdate(const Time &t) const;
+  virtual void
+  collectDependencies(std::vector<const SignalBase<Time> *> &deps) const;
+  virtual bool isForwarder() const { return !autoref(); }
+  virtual bool isConstant() const {
+    return autoref() && Signal<T, Time>::isConstant();
+  }
+  virtual bool pushesUpdates() const;
+  virtual void dependencyDestroyed(const SignalBase<Time> &sig);
   virtual std::ostream &writeGraph(std::ostream &os) const;
   virtual std::ostream &display(std::ostream &os) const;
 
@@ -91,6 +125,8 @@ public: /* --- INHERITANCE --- */
   inline void unsetConstantDefault() { modeNoThrow = false; }
 
   virtual void checkCompatibility();
+  virtual void *getCompatibleValue(const std::type_info &type);
+  virtual bool knowsCompatibleValues() const;
 
 public: /* --- INHERITANCE --- */
   /* SignalPtr could be used as a classical signal, through the normal
@@ -101,6 +137,21 @@ public: /* --- INHERITANCE --- */
     plug(this);
     Signal<T, Time>::setConstant(t);
   }
+  virtual void setConstant(T &&t) {
+    plug(this);
+    Signal<T, Time>::setConstant(std::move(t));
+  }
+  virtual void
+  setSharedConstant(const typename Signal<T, Time>::SharedValue &t) {
+    plug(this);
+    Signal<T, Time>::setSharedConstant(t);
+  }
+  virtual void
+  setSharedReference(const typename Signal<T, Time>::SharedValue *t,
+                     typename Signal<T, Time>::Mutex *m = NULL) {
+    plug(this);
+    Signal<T, Time>::setSharedReference(t, m);
+  }
   virtual void setReference(const T *t,
                             typename Signal<T, Time>::Mutex *m = NULL) {
     plug(this);
@@ -111,6 +162,15 @@ public: /* --- INHERITANCE --- */
     plug(this);
     Signal<T, Time>::setFunction(t, m);
   }
+  virtual void setFunction(const SignalFunction<T, Time> &t,
+                           typename Signal<T, Time>::Mutex *m = NULL) {
+    plug(this);
+    Signal<T, Time>::setFunction(t, m);
+  }
+  virtual void setReferenceLockFree() {
+    plug(this);
+    Signal<T, Time>::setReferenceLockFree();
+  }
 
   /*     template< class Provider > */
   /*    void setFunction( T& (Provider::*fun)(Time,T&),Provider& obj, */
@@ -74,6 +74,12 @@ void SignalPtr<T, Time>::plug(SignalBase<Time> *unknown_ref) {
   if (!unknown_ref) {
     signalPtr = NULL;
     transmitAbstract = false;
+    abstractTransmitter = NULL;
+    updateNotifier();
+    resolve();
+    SignalBase<Time>::invalidateGraph();
+    // The value read by the dependents has changed.
+    this->setDirty();
     dgTDEBUGOUT(5);
     return;
   }
@@ -83,17 +89,12 @@ void SignalPtr<T, Time>::plug(SignalBase<Time> *unknown_ref) {
 
   Signal<T, Time> *ref = dynamic_cast<Signal<T, Time> *>(unknown_ref);
   if (NULL == ref) {
-    try {
-      unknown_ref->checkCompatibility();
-    } catch (T *t) {
-      dgTDEBUG(25) << "Cast THROW ok." << std::endl;
-      Signal<T, Time>::setReference(t);
-      transmitAbstract = true;
-      abstractTransmitter = unknown_ref;
-      transmitAbstractData = t;
-    } catch (...) {
+    // Only the signals which do not know their compatible types throw.
+    T *t = unknown_ref->template getValueOfType<T>();
+    if (NULL == t) {
       dgTDEBUG(25) << "Fatal error." << std::endl;
       transmitAbstract = false;
+      updateNotifier();
       DG_THROW ExceptionSignal(ExceptionSignal::PLUG_IMPOSSIBLE,
                                "Compl. Uncompatible types for plugin.",
                                "(while trying to plug <%s> on <%s>)"
@@ -102,14 +103,90 @@ void SignalPtr<T, Time>::plug(SignalBase<Time> *unknown_ref) {
                                this->getName().c_str(), typeid(T).name(),
                                typeid(unknown_ref).name());
     }
+    Signal<T, Time>::setReference(t);
+    transmitAbstract = true;
+    abstractTransmitter = unknown_ref;
+    transmitAbstractData = t;
   } else {
     dgTDEBUG(25) << "Cast ok." << std::endl;
     transmitAbstract = false;
     signalPtr = ref;
   }
+  updateNotifier();
+  resolve();
+  SignalBase<Time>::invalidateGraph();
+  this->setDirty();
   dgTDEBUGOUT(5);
 }
 
+template <class T, class Time> void SignalPtr<T, Time>::updateNotifier() {
+  SignalBase<Time> *target = getForwarded();
+  if (target != notifier) {
+    if (NULL != notifier)
+      notifier->removeDependent(this);
+    if (NULL != target)
+      target->addDependent(this);
+    notifier = target;
+  }
+}
+
+template <class T, class Time> void SignalPtr<T, Time>::resolve() {
+  // The SignalPtr plugged on another one is skipped: its value is the one
+  // of the signal it is plugged on, unless it is not plugged itself.
+  Signal<T, Time> *res = NULL;
+  if (NULL != signalPtr && !autoref() && !transmitAbstract) {
+    const SignalPtr<T, Time> *next =
+        dynamic_cast<const SignalPtr<T, Time> *>(signalPtr);
+    res = (NULL != next && NULL != next->resolved) ? next->resolved : signalPtr;
+  }
+  if (res == resolved)
+    return;
+  resolved = res;
+  // Ports plugged on this one are its dependents.
+  const std::vector<SignalBase<Time> *> &dependents =
+      SignalBase<Time>::getDependents();
+  for (std::size_t i = 0; i < dependents.size(); ++i) {
+    SignalPtr<T, Time> *port =
+        dynamic_cast<SignalPtr<T, Time> *>(dependents[i]);
+    if (NULL != port && port->signalPtr == this)
+      port->resolve();
+  }
+}
+
+template <class T, class Time>
+bool SignalPtr<T, Time>::pushesUpdates() const {
+  const SignalBase<Time> *target = getForwarded();
+  if (NULL != target)
+    return target->pushesUpdates();
+  return Signal<T, Time>::pushesUpdates();
+}
+
+template <class T, class Time>
+void SignalPtr<T, Time>::dependencyDestroyed(const SignalBase<Time> &sig) {
+  if (&sig == notifier)
+    plug(NULL);
+}
+
+template <class T, class Time>
+void *SignalPtr<T, Time>::getCompatibleValue(const std::type_info &type) {
+  if (isPlugged() && (!autoref())) {
+    return getPtr()->getCompatibleValue(type);
+  } else if (isAbstractPluged() && (!autoref())) {
+    return abstractTransmitter->getCompatibleValue(type);
+  } else
+    return Signal<T, Time>::getCompatibleValue(type);
+}
+
+template <class T, class Time>
+bool SignalPtr<T, Time>::knowsCompatibleValues() const {
+  if (isPlugged() && (!autoref())) {
+    return getPtr()->knowsCompatibleValues();
+  } else if (isAbstractPluged() && (!autoref())) {
+    return abstractTransmitter->knowsCompatibleValues();
+  } else
+    return Signal<T, Time>::knowsCompatibleValues();
+}
+
 template <class T, class Time> void SignalPtr<T, Time>::checkCompatibility() {
   if (isPlugged() && (!autoref())) {
     getPtr()->checkCompatibility();
@@ -121,13 +198,24 @@ template <class T, class Time> void SignalPtr<T, Time>::checkCompatibility() {
 
 template <class T, class Time>
 bool SignalPtr<T, Time>::needUpdate(const Time &t) const {
+  if (NULL != resolved)
+    return resolved->needUpdate(t);
   if ((isAbstractPluged()) && (!autoref())) {
     return getAbstractPtr()->needUpdate(t);
   } else
     return Signal<T, Time>::needUpdate(t);
 }
 
+template <class T, class Time>
+void SignalPtr<T, Time>::collectDependencies(
+    std::vector<const SignalBase<Time> *> &deps) const {
+  if ((isAbstractPluged()) && (!autoref()))
+    deps.push_back(getAbstractPtr());
+}
+
 template <class T, class Time> const Time &SignalPtr<T, Time>::getTime() const {
+  if (NULL != resolved)
+    return resolved->getTime();
   if ((isAbstractPluged()) && (!autoref())) {
     return getAbstractPtr()->getTime();
   }
@@ -152,6 +240,9 @@ const T &SignalPtr<T, Time>::access(const Time &t) {
     abstractTransmitter->recompute(t);
     dgTDEBUGOUT(15);
     return *transmitAbstractData;
+  } else if (NULL != resolved) {
+    dgTDEBUGOUT(15);
+    return resolved->access(t);
   } else {
     dgTDEBUGOUT(15);
     return getPtr()->access(t);
@@ -165,6 +256,8 @@ template <class T, class Time> const T &SignalPtr<T, Time>::accessCopy() const {
     return Signal<T, Time>::accessCopy();
   else if (transmitAbstract)
     return *transmitAbstractData;
+  else if (NULL != resolved)
+    return resolved->accessCopy();
   else
     return getPtr()->accessCopy();
 }
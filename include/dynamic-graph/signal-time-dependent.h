@@ -71,6 +71,9 @@ public:
   SignalTimeDependent(boost::function2<T &, T &, Time> t,
                       const SignalArray_const<Time> &sig,
                       std::string name = "");
+  SignalTimeDependent(const SignalFunction<T, Time> &t,
+                      const SignalArray_const<Time> &sig,
+                      std::string name = "");
 
   virtual ~SignalTimeDependent() {}
 
@@ -92,8 +95,19 @@ public:
   }
 
   virtual bool needUpdate(const Time &t) const;
+  virtual void
+  collectDependencies(std::vector<const SignalBase<Time> *> &deps) const {
+    deps.insert(deps.end(), this->dependencies.begin(),
+                this->dependencies.end());
+  }
   virtual void setPeriodTime(const Time &p);
   virtual Time getPeriodTime() const;
+
+  virtual bool pushesUpdates() const {
+    return Signal<T, Time>::pushesUpdates() ||
+           TimeDependency<Time>::pushesUpdates();
+  }
+  virtual void setDirty();
 };
 
 /* -------------------------------------------- */
@@ -115,6 +129,14 @@ SignalTimeDependent<T, Time>::SignalTimeDependent(
   this->setFunction(t);
 }
 
+template <class T, class Time>
+SignalTimeDependent<T, Time>::SignalTimeDependent(
+    const SignalFunction<T, Time> &t, const SignalArray_const<Time> &sig,
+    std::string name)
+    : Signal<T, Time>(name), TimeDependency<Time>(this, sig) {
+  this->setFunction(t);
+}
+
 template <class T, class Time>
 const T &SignalTimeDependent<T, Time>::access(const Time &t1) {
   const bool up = TimeDependency<Time>::needUpdate(t1);
@@ -123,11 +145,15 @@ const T &SignalTimeDependent<T, Time>::access(const Time &t1) {
   /*       std::cout << "Time before: "<< signalTime << " -- "   */
   /*            << t1<< "  -> Up: "<<up <<std::endl ;   */
   if (up) {
-    TimeDependency<Time>::lastAskForUpdate = false;
+    TimeDependency<Time>::lastAskForUpdate.store(false,
+                                                 std::memory_order_relaxed);
+    TimeDependency<Time>::dirty = false;
     const T &Tres = Signal<T, Time>::access(t1);
     SignalBase<Time>::setReady(false);
     return Tres;
   } else {
+    SignalBase<Time>::profile.countCall();
+    SignalBase<Time>::profile.countCacheHit();
     return Signal<T, Time>::accessCopy();
   }
 }
@@ -154,6 +180,10 @@ bool SignalTimeDependent<T, Time>::needUpdate(const Time &t) const {
   return TimeDependency<Time>::needUpdate(t);
 }
 
+template <class T, class Time> void SignalTimeDependent<T, Time>::setDirty() {
+  TimeDependency<Time>::setDirty();
+}
+
 template <class T, class Time>
 void SignalTimeDependent<T, Time>::setPeriodTime(const Time &p) {
   TimeDependency<Time>::setPeriodTime(p);
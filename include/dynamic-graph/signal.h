@@ -12,11 +12,17 @@
 
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <string>
+#include <type_traits>
 
 #include <dynamic-graph/exception-signal.h>
 #include <dynamic-graph/signal-base.h>
+#include <dynamic-graph/signal-compatibility.h>
+#include <dynamic-graph/signal-function.h>
+#include <dynamic-graph/signal-history.h>
+#include <dynamic-graph/triple-buffer.h>
 
 #ifdef HAVE_LIBBOOST_THREAD
 #include <boost/thread.hpp>
@@ -35,12 +41,28 @@ namespace dynamicgraph {
   \li using the function setConstant(T) to set the value of the signal to T;
   \li using the function setReference(mutex, T*) to set the value
   from a pointer, whose access is restricted by a mutex;
-  \li using the function setFunction(boost::function2) that will be called
-  when the signal's value is accessed.
+  \li using the functions setSharedConstant(SharedValue) or
+  setSharedReference(SharedValue*, mutex) to share an immutable value
+  with its producer instead of copying it;
+  \li using the function setReferenceLockFree() and then publish(T) from
+  another thread, without any lock;
+  \li using the function setFunction(boost::function2) or
+  setFunction(SignalFunction) that will be called when the signal's value is
+  accessed. The latter neither allocates nor goes through type erasure.
+
+  With setHistoryDepth(), the signal also keeps its last values and the
+  times at which they were obtained, see history() and accessHistory().
 */
 template <class T, class Time> class Signal : public SignalBase<Time> {
 protected:
-  enum SignalType { CONSTANT, REFERENCE, REFERENCE_NON_CONST, FUNCTION };
+  enum SignalType {
+    CONSTANT,
+    REFERENCE,
+    REFERENCE_NON_CONST,
+    FUNCTION,
+    REFERENCE_LOCK_FREE,
+    REFERENCE_SHARED
+  };
   static const SignalType SIGNAL_TYPE_DEFAULT = CONSTANT;
 
   SignalType signalType;
@@ -51,6 +73,20 @@ protected:
   const T *Treference;
   T *TreferenceNonConst;
   boost::function2<T &, T &, Time> Tfunction;
+  /// Called by access(): either the function given to
+  /// setFunction(SignalFunction) or a call to Tfunction.
+  SignalFunction<T, Time> Tcallback;
+  TripleBuffer<T> *publication;
+  SignalHistory<T, Time> *valueHistory;
+
+public:
+  /// Reference-counted value which must not be modified once shared.
+  typedef boost::shared_ptr<const T> SharedValue;
+
+protected:
+  /// Shared value currently pointed by Tcopy, if any.
+  SharedValue sharedValue;
+  const SharedValue *sharedReference;
 
   bool keepReference;
   const static bool KEEP_REFERENCE_DEFAULT = false;
@@ -74,23 +110,63 @@ public:
 public:
   /* --- Constructor/destrusctor --- */
   Signal(std::string name);
-  virtual ~Signal() {}
+  virtual ~Signal() {
+    delete publication;
+    delete valueHistory;
+  }
 
   /* --- Generic In/Out function --- */
   virtual void get(std::ostream &value) const;
   virtual void set(std::istringstream &value);
   virtual void trace(std::ostream &os) const;
+  virtual bool isConstant() const { return CONSTANT == signalType && copyInit; }
+  virtual void writeValue(std::ostream &os) const;
+  virtual void readValue(std::istream &is);
+  virtual std::string getBinaryTraceFormat() const;
+  virtual void traceBinary(std::ostream &os) const;
 
   /* --- Generic Set function --- */
   virtual void setConstant(const T &t);
+  /// Same, moving t instead of copying it. A subclass which overrides
+  /// setConstant(const T&) must override this function too (as SignalPtr
+  /// does): the rvalues given to a Signal would otherwise bypass its
+  /// override.
+  virtual void setConstant(T &&t);
+  /// Hold t as the constant value of the signal, without copying it.
+  virtual void setSharedConstant(const SharedValue &t);
+  /// Same as setReference(), sharing the value pointed by t on access
+  /// instead of copying it. The provider must replace the pointer by a new
+  /// value rather than modify the pointed value, and never make it empty.
+  virtual void setSharedReference(const SharedValue *t, Mutex *mutexref = NULL);
   virtual void setReference(const T *t, Mutex *mutexref = NULL);
   virtual void setReferenceNonConstant(T *t, Mutex *mutexref = NULL);
   virtual void setFunction(boost::function2<T &, T &, Time> t,
                            Mutex *mutexref = NULL);
+  virtual void setFunction(const SignalFunction<T, Time> &t,
+                           Mutex *mutexref = NULL);
+
+  /// Get the value from publish(), which can be called from another
+  /// thread. Neither of the threads waits for the other: access() returns
+  /// the latest value completely published.
+  virtual void setReferenceLockFree();
+  /// Publish a new value. Only one thread can publish values of the signal.
+  void publish(const T &t);
 
   inline bool getKeepReference() { return keepReference; }
   inline void setKeepReference(const bool &b) { keepReference = b; }
 
+  /* --- History --- */
+  /// Keep the last depth values of the signal, 0 disabling the history.
+  /// The memory is allocated by this function, and not when the values are
+  /// recorded.
+  void setHistoryDepth(const std::size_t depth);
+  std::size_t getHistoryDepth() const;
+  /// Value of the signal k values ago, history(0) being the current value.
+  const T &history(const std::size_t k) const;
+  /// Value of the signal at time t, i.e. the latest value obtained at or
+  /// before t. Unlike access(), it never recomputes the signal.
+  const T &accessHistory(const Time &t) const;
+
   /* --- Signal computation --- */
   virtual const T &access(const Time &t);
   virtual inline void recompute(const Time &t) { access(t); }
@@ -110,12 +186,40 @@ public:
   /// checkCompatibility is used to get the object contained in the
   /// signal. This used to verify if a dynamic cast is possible or not.
   virtual void checkCompatibility() { throw Tcopy; }
+  /// The value is compatible with T, and with the types to which T has a
+  /// conversion in SignalCompatibility.
+  virtual void *getCompatibleValue(const std::type_info &type) {
+    if (type == typeid(T))
+      return Tcopy;
+    SignalCompatibility::Conversion conversion =
+        SignalCompatibility::getInstance().getConversion(typeid(T), type);
+    return (NULL == conversion) ? NULL : conversion(Tcopy);
+  }
+  /// A value of a class type can also be read as one of its base classes,
+  /// through checkCompatibility(): only the other types are fully known.
+  virtual bool knowsCompatibleValues() const {
+    return !std::is_class<T>::value;
+  }
+
+  /// Constant signals notify their dependents when they are set.
+  virtual bool pushesUpdates() const { return CONSTANT == signalType; }
+
+protected:
+  void setSignalType(const SignalType &type);
 
 private:
   const T &setTcopy(const T &t);
+  const T &setTcopy(T &&t);
+  const T &setTcopy(const SharedValue &t);
+  const T &setTcopyShared();
+  // Body of access().
+  const T &accessValue(const Time &t);
   T &getTwork();
   const T &getTwork() const;
   const T &switchTcopy();
+  void callTcallback(const Time &t);
+  void recordHistory();
+  static T &callTfunction(void *sig, T &res, const Time &t);
 };
 
 } // end of namespace dynamicgraph
@@ -5,6 +5,8 @@
 
 #ifndef DYNAMIC_GRAPH_SIGNAL_T_CPP
 #define DYNAMIC_GRAPH_SIGNAL_T_CPP
+#include <dynamic-graph/allocation-detector.h>
+#include <dynamic-graph/signal-binary-io.h>
 #include <dynamic-graph/signal-caster.h>
 #include <dynamic-graph/signal.h>
 
@@ -15,7 +17,9 @@
 #define __SIGNAL_INIT(name, Tcpy, Tref, TrefNC, mutex)                         \
   SignalBase<Time>(name), signalType(SIGNAL_TYPE_DEFAULT), Tcopy1(Tcpy),       \
       Tcopy2(Tcpy), Tcopy(&Tcopy1), Treference(Tref),                          \
-      TreferenceNonConst(TrefNC), Tfunction(),                                 \
+      TreferenceNonConst(TrefNC), Tfunction(), Tcallback(),                    \
+      publication(NULL), valueHistory(NULL),                                   \
+      sharedValue(), sharedReference(NULL),                                    \
       keepReference(KEEP_REFERENCE_DEFAULT), providerMutex(mutex)
 
 namespace dynamicgraph {
@@ -26,6 +30,26 @@ Signal<T, Time>::Signal(std::string name)
   return;
 }
 
+template <class T, class Time>
+void Signal<T, Time>::writeValue(std::ostream &os) const {
+  signal_binary_io<T>::write(this->accessCopy(), os);
+}
+
+template <class T, class Time>
+void Signal<T, Time>::readValue(std::istream &is) {
+  this->setConstant(signal_binary_io<T>::read(is));
+}
+
+template <class T, class Time>
+std::string Signal<T, Time>::getBinaryTraceFormat() const {
+  return signal_binary_io<T>::format(this->accessCopy());
+}
+
+template <class T, class Time>
+void Signal<T, Time>::traceBinary(std::ostream &os) const {
+  signal_binary_io<T>::record(this->accessCopy(), os);
+}
+
 /* ------------------------------------------------------------------------ */
 
 template <class T, class Time>
@@ -56,16 +80,51 @@ template <class T, class Time> const T &Signal<T, Time>::setTcopy(const T &t) {
   if (Tcopy == &Tcopy1) {
     Tcopy2 = t;
     copyInit = true;
+    SignalBase<Time>::incrementVersion();
     Tcopy = &Tcopy2;
+    sharedValue.reset();
+    recordHistory();
     return Tcopy2;
   } else {
     Tcopy1 = t;
     copyInit = true;
+    SignalBase<Time>::incrementVersion();
     Tcopy = &Tcopy1;
+    sharedValue.reset();
+    recordHistory();
     return Tcopy1;
   }
 }
 
+template <class T, class Time> const T &Signal<T, Time>::setTcopy(T &&t) {
+  T &Twork = getTwork();
+  Twork = std::move(t);
+  copyInit = true;
+  return switchTcopy();
+}
+
+template <class T, class Time>
+const T &Signal<T, Time>::setTcopy(const SharedValue &t) {
+  // Tcopy is never written through: the shared value stays immutable.
+  sharedValue = t;
+  Tcopy = const_cast<T *>(sharedValue.get());
+  copyInit = true;
+  SignalBase<Time>::incrementVersion();
+  recordHistory();
+  return *sharedValue;
+}
+
+template <class T, class Time> const T &Signal<T, Time>::setTcopyShared() {
+  // Copy the pointer first: the provider may replace it meanwhile.
+  const SharedValue value = *sharedReference;
+  if (!value) {
+    DG_THROW ExceptionSignal(ExceptionSignal::NOT_INITIALIZED,
+                             "The shared reference is null. ", "(in %s).",
+                             SignalBase<Time>::getName().c_str());
+  }
+  return setTcopy(value);
+}
+
 template <class T, class Time> T &Signal<T, Time>::getTwork() {
   if (Tcopy == &Tcopy1)
     return Tcopy2;
@@ -81,24 +140,131 @@ template <class T, class Time> const T &Signal<T, Time>::getTwork() const {
 }
 
 template <class T, class Time> const T &Signal<T, Time>::switchTcopy() {
-  if (Tcopy == &Tcopy1) {
+  sharedValue.reset();
+  SignalBase<Time>::incrementVersion();
+  if (Tcopy == &Tcopy1)
     Tcopy = &Tcopy2;
-    return Tcopy2;
-  } else {
+  else
     Tcopy = &Tcopy1;
-    return Tcopy1;
+  recordHistory();
+  return *Tcopy;
+}
+
+template <class T, class Time>
+void Signal<T, Time>::callTcallback(const Time &t) {
+  if (SignalBase<Time>::profile.countRecompute()) {
+    const SignalProfile::Clock::time_point start = SignalProfile::Clock::now();
+    Tcallback(getTwork(), t);
+    SignalBase<Time>::profile.addTime(SignalProfile::Clock::now() - start);
+  } else {
+    Tcallback(getTwork(), t);
+  }
+}
+
+template <class T, class Time> void Signal<T, Time>::recordHistory() {
+  if (NULL != valueHistory)
+    valueHistory->record(*Tcopy, signalTime);
+}
+
+template <class T, class Time>
+void Signal<T, Time>::setHistoryDepth(const std::size_t depth) {
+  delete valueHistory;
+  valueHistory = NULL;
+  if (0 < depth) {
+    valueHistory = new SignalHistory<T, Time>(depth, *Tcopy);
+    if (copyInit)
+      recordHistory();
+  }
+}
+
+template <class T, class Time>
+std::size_t Signal<T, Time>::getHistoryDepth() const {
+  return (NULL == valueHistory) ? 0 : valueHistory->getDepth();
+}
+
+template <class T, class Time>
+const T &Signal<T, Time>::history(const std::size_t k) const {
+  if (NULL == valueHistory || k >= valueHistory->getSize()) {
+    DG_THROW ExceptionSignal(ExceptionSignal::NOT_INITIALIZED,
+                             "Value not in the history of the signal. ",
+                             "(while trying to get value %d of %s).",
+                             static_cast<int>(k),
+                             SignalBase<Time>::getName().c_str());
+  }
+  return valueHistory->getValue(k);
+}
+
+template <class T, class Time>
+const T &Signal<T, Time>::accessHistory(const Time &t) const {
+  const std::size_t k = (NULL == valueHistory) ? 0 : valueHistory->find(t);
+  if (NULL == valueHistory || k >= valueHistory->getSize()) {
+    std::ostringstream time;
+    time << t;
+    DG_THROW ExceptionSignal(
+        ExceptionSignal::NOT_INITIALIZED,
+        "Value not in the history of the signal. ",
+        "(while trying to get the value of %s at time %s).",
+        SignalBase<Time>::getName().c_str(), time.str().c_str());
+  }
+  return valueHistory->getValue(k);
+}
+
+template <class T, class Time>
+void Signal<T, Time>::setSignalType(const SignalType &type) {
+  if (type != signalType) {
+    signalType = type;
+    // Whether the signal pushes its updates depends on its type.
+    SignalBase<Time>::invalidateGraph();
   }
 }
 
 template <class T, class Time> void Signal<T, Time>::setConstant(const T &t) {
-  signalType = CONSTANT;
+  setSignalType(CONSTANT);
   setTcopy(t);
   setReady();
+  SignalBase<Time>::notifyDependents();
+}
+
+template <class T, class Time> void Signal<T, Time>::setConstant(T &&t) {
+  setSignalType(CONSTANT);
+  setTcopy(std::move(t));
+  setReady();
+  SignalBase<Time>::notifyDependents();
+}
+
+template <class T, class Time>
+void Signal<T, Time>::setSharedConstant(const SharedValue &t) {
+  if (!t) {
+    DG_THROW ExceptionSignal(ExceptionSignal::SET_IMPOSSIBLE,
+                             "Set operation not possible with a null value. ",
+                             "(while trying to set %s).",
+                             SignalBase<Time>::getName().c_str());
+  }
+  setSignalType(CONSTANT);
+  setTcopy(t);
+  setReady();
+  SignalBase<Time>::notifyDependents();
+}
+
+template <class T, class Time>
+void Signal<T, Time>::setSharedReference(const SharedValue *t,
+                                         Mutex *mutexref) {
+  if (NULL == t || !*t) {
+    DG_THROW ExceptionSignal(ExceptionSignal::SET_IMPOSSIBLE,
+                             "Set operation not possible with a null value. ",
+                             "(while trying to set %s).",
+                             SignalBase<Time>::getName().c_str());
+  }
+  setSignalType(REFERENCE_SHARED);
+  sharedReference = t;
+  providerMutex = mutexref;
+  copyInit = false;
+  setReady();
 }
 
 template <class T, class Time>
 void Signal<T, Time>::setReference(const T *t, Mutex *mutexref) {
-  signalType = REFERENCE;
+  setSignalType(REFERENCE);
   Treference = t;
   providerMutex = mutexref;
   copyInit = false;
@@ -107,7 +273,7 @@ void Signal<T, Time>::setReference(const T *t, Mutex *mutexref) {
 
 template <class T, class Time>
 void Signal<T, Time>::setReferenceNonConstant(T *t, Mutex *mutexref) {
-  signalType = REFERENCE_NON_CONST;
+  setSignalType(REFERENCE_NON_CONST);
   Treference = t;
   TreferenceNonConst = t;
   providerMutex = mutexref;
@@ -118,18 +284,61 @@ void Signal<T, Time>::setReferenceNonConstant(T *t, Mutex *mutexref) {
 template <class T, class Time>
 void Signal<T, Time>::setFunction(boost::function2<T &, T &, Time> t,
                                   Mutex *mutexref) {
-  signalType = FUNCTION;
+  setSignalType(FUNCTION);
   Tfunction = t;
+  Tcallback = SignalFunction<T, Time>(this, &Signal<T, Time>::callTfunction);
+  providerMutex = mutexref;
+  copyInit = false;
+  setReady();
+}
+
+template <class T, class Time>
+void Signal<T, Time>::setFunction(const SignalFunction<T, Time> &t,
+                                  Mutex *mutexref) {
+  setSignalType(FUNCTION);
+  Tfunction.clear();
+  Tcallback = t;
   providerMutex = mutexref;
   copyInit = false;
   setReady();
 }
 
+template <class T, class Time>
+T &Signal<T, Time>::callTfunction(void *sig, T &res, const Time &t) {
+  return static_cast<Signal<T, Time> *>(sig)->Tfunction(res, t);
+}
+
+template <class T, class Time> void Signal<T, Time>::setReferenceLockFree() {
+  if (NULL == publication)
+    publication = new TripleBuffer<T>();
+  setSignalType(REFERENCE_LOCK_FREE);
+  providerMutex = NULL;
+  setReady();
+}
+
+template <class T, class Time> void Signal<T, Time>::publish(const T &t) {
+  if (NULL == publication) {
+    DG_THROW ExceptionSignal(
+        ExceptionSignal::SET_IMPOSSIBLE,
+        "Publish operation not possible with this signal. ",
+        "(%s is not a lock-free reference).",
+        SignalBase<Time>::getName().c_str());
+  }
+  publication->publish(t);
+}
+
 template <class T, class Time> const T &Signal<T, Time>::accessCopy() const {
   return *Tcopy;
 }
 
 template <class T, class Time> const T &Signal<T, Time>::access(const Time &t) {
+  AllocationDetector::Scope allocationScope(SignalBase<Time>::getName());
+  SignalBase<Time>::profile.countCall();
+  return accessValue(t);
+}
+
+template <class T, class Time>
+const T &Signal<T, Time>::accessValue(const Time &t) {
   switch (signalType) {
   case REFERENCE:
   case REFERENCE_NON_CONST: {
@@ -156,7 +365,7 @@ template <class T, class Time> const T &Signal<T, Time>::access(const Time &t) {
   case FUNCTION: {
     if (NULL == providerMutex) {
       signalTime = t;
-      Tfunction(getTwork(), t);
+      callTcallback(t);
       copyInit = true;
       return switchTcopy();
     } else {
@@ -165,7 +374,7 @@ template <class T, class Time> const T &Signal<T, Time>::access(const Time &t) {
         boost::try_mutex::scoped_try_lock lock(*providerMutex);
 #endif
         signalTime = t;
-        Tfunction(getTwork(), t);
+        callTcallback(t);
         copyInit = true;
         return switchTcopy();
       } catch (const MutexError &) {
@@ -174,6 +383,38 @@ template <class T, class Time> const T &Signal<T, Time>::access(const Time &t) {
     }
     break;
   }
+  case REFERENCE_SHARED: {
+    if (NULL == providerMutex) {
+      signalTime = t;
+      return setTcopyShared();
+    } else {
+      try {
+#ifdef HAVE_LIBBOOST_THREAD
+        boost::try_mutex::scoped_try_lock lock(*providerMutex);
+#endif
+        signalTime = t;
+        return setTcopyShared();
+      } catch (const MutexError &) {
+        return accessCopy();
+      }
+    }
+  }
+
+  case REFERENCE_LOCK_FREE: {
+    signalTime = t;
+    if (publication->update()) {
+      // Take the published buffer rather than copying it: the previous
+      // working copy becomes one of the buffers of the publisher.
+      using std::swap;
+      swap(getTwork(), publication->getFrontBuffer());
+      copyInit = true;
+      return switchTcopy();
+    }
+    // Only the time has changed.
+    SignalBase<Time>::newUpdateEpoch();
+    return accessCopy();
+  }
+
   case CONSTANT:
   default:
     if (this->getReady()) {
@@ -223,6 +464,12 @@ std::ostream &Signal<T, Time>::display(std::ostream &os) const {
   case Signal<T, Time>::FUNCTION:
     os << "Fun";
     break;
+  case Signal<T, Time>::REFERENCE_LOCK_FREE:
+    os << "RefLockFree";
+    break;
+  case Signal<T, Time>::REFERENCE_SHARED:
+    os << "RefShared";
+    break;
   }
   return os << ")";
 }
@@ -0,0 +1,54 @@
+// -*- mode: c++ -*-
+// Copyright 2020, LAAS-CNRS
+//
+
+#ifndef DYNAMIC_GRAPH_THREAD_POOL_H
+#define DYNAMIC_GRAPH_THREAD_POOL_H
+#include <cstddef>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <dynamic-graph/dynamic-graph-api.h>
+
+namespace dynamicgraph {
+/// \ingroup dgraph
+///
+/// \brief Fixed set of worker threads used to evaluate independent parts of
+/// the graph during one tick (see ExecutionPlan::runTick).
+///
+/// The calling thread takes part in the work: a pool of size N uses N-1
+/// worker threads. The tasks of one call to parallelFor() are distributed
+/// dynamically: each thread fetches the next index from a shared cursor as
+/// soon as it is idle, so that a long task does not delay the others.
+class DYNAMIC_GRAPH_DLLAPI ThreadPool : private boost::noncopyable {
+public:
+  typedef boost::function<void(std::size_t)> Task;
+
+  /// \param size number of threads, including the calling one.
+  /// \param pinned if true, worker i is bound to the CPU i+1 (modulo the
+  ///        number of CPUs), CPU 0 being left to the calling thread.
+  explicit ThreadPool(const std::size_t &size, const bool &pinned = false);
+  ~ThreadPool();
+
+  std::size_t size() const { return workers.size() + 1; }
+
+  /// Call task(i) for each i in [0, n) and return when all the calls are
+  /// done. The first exception thrown by a task is rethrown in the caller.
+  void parallelFor(const std::size_t &n, const Task &task);
+
+private:
+  struct Worker;
+  struct Job;
+
+  void work(Job &job);
+  void spin(const std::size_t &id, const bool &pinned);
+
+  std::vector<Worker *> workers;
+  Job *job;
+};
+
+} // end of namespace dynamicgraph
+
+#endif //! DYNAMIC_GRAPH_THREAD_POOL_H
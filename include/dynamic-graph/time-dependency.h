@@ -5,7 +5,9 @@
 
 #ifndef DYNAMIC_GRAPH_TIME_DEPENDENCY_H
 #define DYNAMIC_GRAPH_TIME_DEPENDENCY_H
-#include <list>
+#include <atomic>
+
+#include <boost/container/small_vector.hpp>
 
 #include <dynamic-graph/fwd.hh>
 #include <dynamic-graph/signal-array.h>
@@ -14,17 +16,40 @@
 namespace dynamicgraph {
 /** \brief A helper class for setting and specifying dependencies
     between signals.
+
+    With the VERSION_DEPENDENT type, the signal is only recomputed when one
+    of its dependencies has been modified since the last computation. The
+    modifications are pushed through the reverse edges of the graph (see
+    SignalBase::setDirty()) when all the dependencies push their updates,
+    i.e. are constants or VERSION_DEPENDENT signals themselves: checking
+    whether a whole sub-graph is up to date then costs a single test. As
+    soon as one dependency does not push its updates (a function or a
+    reference for instance), the dependencies are polled as with
+    TIME_DEPENDENT, the period being ignored.
 */
-template <class Time> class TimeDependency {
+template <class Time> class TimeDependency : public DependencyHolder<Time> {
 public:
-  enum DependencyType { TIME_DEPENDENT, BOOL_DEPENDENT, ALWAYS_READY };
+  enum DependencyType {
+    TIME_DEPENDENT,
+    BOOL_DEPENDENT,
+    ALWAYS_READY,
+    VERSION_DEPENDENT
+  };
 
-  mutable Time lastAskForUpdate;
+  /// Non-zero when needUpdate() returned true, until the signal is
+  /// recomputed.
+  mutable std::atomic<Time> lastAskForUpdate;
 
 public:
   SignalBase<Time> &leader;
 
-  typedef std::list<const SignalBase<Time> *> Dependencies;
+  /// Contiguous storage, the first DEPENDENCIES_INLINE_SIZE dependencies
+  /// being stored in the object itself. The last added dependency comes
+  /// first.
+  static const std::size_t DEPENDENCIES_INLINE_SIZE = 4;
+  typedef boost::container::small_vector<const SignalBase<Time> *,
+                                         DEPENDENCIES_INLINE_SIZE>
+      Dependencies;
   static const DependencyType DEPENDENCY_TYPE_DEFAULT = TIME_DEPENDENT;
 
   Dependencies dependencies;
@@ -36,16 +61,20 @@ public:
   Time periodTime;
   static const Time PERIOD_TIME_DEFAULT = 1;
 
+  /// VERSION_DEPENDENT: a dependency has been modified since the last
+  /// computation.
+  bool dirty;
+
 public:
   TimeDependency(SignalBase<Time> *sig,
                  const DependencyType dep = DEPENDENCY_TYPE_DEFAULT);
   TimeDependency(SignalBase<Time> *sig, const SignalArray_const<Time> &arr,
                  const DependencyType dep = DEPENDENCY_TYPE_DEFAULT);
-  virtual ~TimeDependency() {}
+  virtual ~TimeDependency();
 
   void addDependencies(const SignalArray_const<Time> &arr);
   void addDependency(const SignalBase<Time> &sig);
-  void removeDependency(const SignalBase<Time> &sig);
+  virtual void removeDependency(const SignalBase<Time> &sig);
   void clearDependency();
 
   virtual std::ostream &writeGraph(std::ostream &os) const;
@@ -54,17 +83,56 @@ public:
                                     std::string next1 = "",
                                     std::string next2 = "") const;
 
+  /// The result of the check of the dependencies is memoized for the
+  /// last queried time, as long as the update epoch (see
+  /// SignalBase::getUpdateEpoch()) is unchanged. In a graph where several
+  /// paths lead to the same signal, the check is thus linear in the number
+  /// of signals instead of the number of paths.
   bool needUpdate(const Time &t1) const;
 
-  void setDependencyType(DependencyType dep) { dependencyType = dep; }
+  /// Number of calls to needUpdate() answered from the memoized result
+  /// instead of checking the dependencies again.
+  unsigned long getNbMemoizedQueries() const {
+    return nbMemoizedQueries.load(std::memory_order_relaxed);
+  }
+
+  void setDependencyType(DependencyType dep);
+
+  /// Mark the leader as modified, and notify its dependents if it is
+  /// VERSION_DEPENDENT. Each of them is notified, even if the leader was
+  /// already dirty.
+  void setDirty();
+
+  /// Return true if the type is VERSION_DEPENDENT and all the dependencies
+  /// push their updates.
+  bool pushesUpdates() const;
 
   void setNeedUpdateFromAllChildren(const bool b = true) {
     updateFromAllChildren = b;
+    SignalBase<Time>::newUpdateEpoch();
   }
   bool getNeedUpdateFromAllChildren() const { return updateFromAllChildren; }
 
-  void setPeriodTime(const Time &p) { periodTime = p; }
+  void setPeriodTime(const Time &p) {
+    periodTime = p;
+    SignalBase<Time>::newUpdateEpoch();
+  }
   Time getPeriodTime() const { return periodTime; }
+
+private:
+  // Cache of pushesUpdates(), valid for the graph revision pushRevision.
+  mutable bool pushing;
+  mutable unsigned long pushRevision;
+  // Time and update epoch of the last check of the dependencies which
+  // concluded that no update was needed. A polled dependency shared by the
+  // signals of a level of an ExecutionPlan is queried by several threads:
+  // they only write these fields when the values change.
+  mutable std::atomic<Time> lastQueryTime;
+  mutable std::atomic<unsigned long> lastQueryEpoch;
+  mutable std::atomic<unsigned long> nbMemoizedQueries;
+  // Last propagation of a modification which reached the leader (see
+  // SignalBase::getNotificationRound()).
+  unsigned long lastNotification;
 };
 
 } // end of namespace dynamicgraph
@@ -12,28 +12,42 @@
 #include <dynamic-graph/debug.h>
 
 #define __TIME_DEPENDENCY_INIT(sig, dep)                                       \
-  leader(*sig), dependencies(), updateFromAllChildren(ALL_READY_DEFAULT),      \
-      dependencyType(dep), periodTime(PERIOD_TIME_DEFAULT)
+  lastAskForUpdate(false), leader(*sig), dependencies(),                       \
+      updateFromAllChildren(ALL_READY_DEFAULT), dependencyType(dep),           \
+      periodTime(PERIOD_TIME_DEFAULT), dirty(true), pushing(false),            \
+      pushRevision(0), lastQueryTime(Time()), lastQueryEpoch(0),               \
+      nbMemoizedQueries(0), lastNotification(0)
 
 namespace dynamicgraph {
 template <class Time>
 TimeDependency<Time>::TimeDependency(SignalBase<Time> *sig,
                                      const DependencyType dep)
-    : __TIME_DEPENDENCY_INIT(sig, dep) {}
+    : __TIME_DEPENDENCY_INIT(sig, dep) {
+  leader.dependencyHolder = this;
+}
 
 template <class Time>
 TimeDependency<Time>::TimeDependency(SignalBase<Time> *sig,
                                      const SignalArray_const<Time> &ar,
                                      const DependencyType dep)
     : __TIME_DEPENDENCY_INIT(sig, dep) {
+  leader.dependencyHolder = this;
   addDependencies(ar);
 
   return;
 }
 
+template <class Time> TimeDependency<Time>::~TimeDependency() {
+  leader.dependencyHolder = NULL;
+  for (typename Dependencies::const_iterator it = dependencies.begin();
+       it != dependencies.end(); ++it)
+    (*it)->removeDependent(&leader);
+}
+
 /* ------------------------------------------------------------------------ */
 template <class Time>
 void TimeDependency<Time>::addDependencies(const SignalArray_const<Time> &ar) {
+  dependencies.reserve(dependencies.size() + ar.getSize());
   for (unsigned int i = 0; i < ar.getSize(); ++i) {
     addDependency(ar[i]);
   }
@@ -41,16 +55,72 @@ void TimeDependency<Time>::addDependencies(const SignalArray_const<Time> &ar) {
 
 template <class Time>
 void TimeDependency<Time>::addDependency(const SignalBase<Time> &sig) {
-  dependencies.push_front(&sig);
+  dependencies.insert(dependencies.begin(), &sig);
+  sig.addDependent(&leader);
+  SignalBase<Time>::invalidateGraph();
+  setDirty();
 }
 
 template <class Time>
 void TimeDependency<Time>::removeDependency(const SignalBase<Time> &sig) {
-  dependencies.remove(&sig);
+  dependencies.erase(
+      std::remove(dependencies.begin(), dependencies.end(), &sig),
+      dependencies.end());
+  sig.removeDependent(&leader);
+  SignalBase<Time>::invalidateGraph();
+  setDirty();
 }
 
 template <class Time> void TimeDependency<Time>::clearDependency() {
+  for (typename Dependencies::const_iterator it = dependencies.begin();
+       it != dependencies.end(); ++it)
+    (*it)->removeDependent(&leader);
   dependencies.clear();
+  SignalBase<Time>::invalidateGraph();
+  setDirty();
+}
+
+template <class Time>
+void TimeDependency<Time>::setDependencyType(DependencyType dep) {
+  if (dep != dependencyType) {
+    dependencyType = dep;
+    // The dependents may have to poll this signal, or stop doing so.
+    SignalBase<Time>::invalidateGraph();
+    setDirty();
+  }
+}
+
+template <class Time> void TimeDependency<Time>::setDirty() {
+  // Only VERSION_DEPENDENT signals are not polled by their dependents.
+  dirty = true;
+  if (VERSION_DEPENDENT != dependencyType)
+    return;
+  const bool outermost = SignalBase<Time>::beginNotification();
+  // Notified once per modification, even through several paths.
+  const unsigned long round = SignalBase<Time>::getNotificationRound();
+  if (round != lastNotification) {
+    lastNotification = round;
+    leader.notifyDependents();
+  }
+  SignalBase<Time>::endNotification(outermost);
+}
+
+template <class Time> bool TimeDependency<Time>::pushesUpdates() const {
+  if (VERSION_DEPENDENT != dependencyType)
+    return false;
+  const unsigned long revision = SignalBase<Time>::getGraphRevision();
+  if (revision != pushRevision) {
+    // Considered as not pushing while visiting the dependencies, which
+    // ends the recursion in case of cycle.
+    pushRevision = revision;
+    pushing = false;
+    bool res = true;
+    for (typename Dependencies::const_iterator it = dependencies.begin();
+         res && it != dependencies.end(); ++it)
+      res = (*it)->pushesUpdates();
+    pushing = res;
+  }
+  return pushing;
 }
 
 template <class Time>
@@ -62,7 +132,7 @@ bool TimeDependency<Time>::needUpdate(const Time &t1) const {
     dgTDEBUGOUT(15);
     return true;
   }
-  if (lastAskForUpdate) {
+  if (lastAskForUpdate.load(std::memory_order_relaxed)) {
     dgTDEBUGOUT(15);
     return true;
   }
@@ -74,6 +144,17 @@ bool TimeDependency<Time>::needUpdate(const Time &t1) const {
   }
   case BOOL_DEPENDENT:
     break;
+  case VERSION_DEPENDENT: {
+    if (dirty) {
+      dgTDEBUGOUT(15);
+      return true;
+    }
+    if (pushesUpdates()) {
+      dgTDEBUGOUT(15);
+      return false;
+    }
+    break;
+  }
   case TIME_DEPENDENT: {
     if (t1 < leader.getTime() + periodTime) {
       dgTDEBUGOUT(15);
@@ -83,6 +164,14 @@ bool TimeDependency<Time>::needUpdate(const Time &t1) const {
   }
   };
 
+  const unsigned long epoch = SignalBase<Time>::getUpdateEpoch();
+  if (epoch == lastQueryEpoch.load(std::memory_order_relaxed) &&
+      t1 == lastQueryTime.load(std::memory_order_relaxed)) {
+    nbMemoizedQueries.fetch_add(1, std::memory_order_relaxed);
+    dgTDEBUGOUT(15);
+    return false;
+  }
+
   bool res = updateFromAllChildren;
   const typename Dependencies::const_iterator itend = dependencies.end();
   for (typename Dependencies::const_iterator it = dependencies.begin();
@@ -105,7 +194,15 @@ bool TimeDependency<Time>::needUpdate(const Time &t1) const {
         continue;
     }
   }
-  lastAskForUpdate = res;
+  if (res != static_cast<bool>(
+                 lastAskForUpdate.load(std::memory_order_relaxed)))
+    lastAskForUpdate.store(res, std::memory_order_relaxed);
+  if (!res) {
+    if (epoch != lastQueryEpoch.load(std::memory_order_relaxed))
+      lastQueryEpoch.store(epoch, std::memory_order_relaxed);
+    if (!(t1 == lastQueryTime.load(std::memory_order_relaxed)))
+      lastQueryTime.store(t1, std::memory_order_relaxed);
+  }
 
   dgTDEBUGOUT(15);
   return res;
@@ -127,6 +224,9 @@ TimeDependency<Time>::displayDependencies(std::ostream &os, const int depth,
   case ALWAYS_READY:
     os << "A";
     break;
+  case VERSION_DEPENDENT:
+    os << "v=" << leader.getVersion() << (dirty ? " dirty" : "");
+    break;
   case BOOL_DEPENDENT:
     os << "ready=" << ((leader.getReady()) ? "TRUE" : "FALSE");
     break;
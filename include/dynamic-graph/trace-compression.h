@@ -0,0 +1,145 @@
+// -*- mode: c++ -*-
+// Copyright 2020, LAAS-CNRS
+//
+
+#ifndef DYNAMIC_GRAPH_TRACE_COMPRESSION_H
+#define DYNAMIC_GRAPH_TRACE_COMPRESSION_H
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <dynamic-graph/dynamic-graph-api.h>
+
+namespace dynamicgraph {
+/// \ingroup debug
+///
+/// \brief Compression of the binary traces (see Tracer::BINARY), as they
+/// are written.
+///
+/// The header of the trace gives the format of its records (a time and the
+/// data of one or several values). The records are then encoded column by
+/// column, each one relative to the previous record, as in the Gorilla
+/// time-series database: the integers, such as the time, by the difference
+/// of their successive differences, and the floating-point numbers by the
+/// bits which differ from the previous value. A constant value takes one
+/// bit per record, and a time increasing by a constant step also.
+///
+/// The compressed trace is the string "dynamic-graph compressed trace 1",
+/// followed by the header of the binary trace and by the encoded records.
+/// Traces whose records do not have a fixed size (see
+/// signal_binary_io::format()) are written without compression. The data
+/// is read back with decompressTrace().
+///
+/// Kept exactly, the floating-point numbers of smooth signals, such as the
+/// positions of joints, compress poorly: their last bits change at each
+/// record. Given a precision, the compressor rounds them to a multiple of
+/// it, and encodes these multiples as the integers. The trace then starts
+/// with the string "dynamic-graph quantized trace 1" followed by the
+/// precision as a float64. Not-a-number, the infinities and the numbers
+/// too large to be rounded are kept exactly.
+class DYNAMIC_GRAPH_DLLAPI TraceCompressor : private boost::noncopyable {
+public:
+  /// Type of a column of the records.
+  struct Column {
+    bool isFloat;
+    bool isSigned;
+    /// Size in bytes.
+    unsigned int size;
+    /// Precision to which the floating-point numbers are rounded, 0 if
+    /// they are kept exactly.
+    double precision;
+
+    // Previous value, and its state for the encoding.
+    bool first;
+    std::uint64_t previous;
+    std::uint64_t previousDelta;
+    int leading, trailing;
+  };
+
+  /// Compress the data to os, rounding the floating-point numbers to
+  /// precision if it is positive.
+  explicit TraceCompressor(std::ostream &os, const double &precision = 0.);
+
+  /// Add the data of the binary trace.
+  void write(const char *data, const std::streamsize &size);
+  /// Write the end of the compressed data. Nothing can be written after.
+  void finish();
+
+  /// Read the header of a binary trace from is, copy it to header, and add
+  /// the columns of its records to columns. Return false if it is not the
+  /// header of a binary trace with records of a fixed size. Throw
+  /// ExceptionSignal if the header is incomplete.
+  static bool readHeader(std::istream &is, std::ostream &header,
+                         std::vector<Column> &columns);
+
+  /// Round the floating-point numbers of the columns to precision.
+  static void setPrecision(std::vector<Column> &columns,
+                           const double &precision);
+
+private:
+  std::ostream &os;
+  const double precision;
+  // Data which is not processed yet: the header or an incomplete record.
+  std::string pending;
+  enum State { HEADER, COMPRESS, COPY, FINISHED } state;
+  std::vector<Column> columns;
+  std::size_t recordSize;
+  // Last byte of the encoded data, not complete yet.
+  unsigned char current;
+  int used;
+  std::string out;
+
+  void put(const std::uint64_t &value, const int &nbBits);
+  void encode(const char *record);
+  void encodeQuantized(Column &column, const std::uint64_t &value);
+};
+
+/// \ingroup debug
+///
+/// \brief File in which a binary trace is written compressed (see
+/// TraceCompressor).
+class DYNAMIC_GRAPH_DLLAPI CompressedTraceFile : public std::ostream {
+public:
+  /// See TraceCompressor for the precision.
+  explicit CompressedTraceFile(const std::string &filename,
+                               const double &precision = 0.);
+  /// Write the end of the data, and close the file.
+  ~CompressedTraceFile();
+
+private:
+  class Buffer : public std::streambuf {
+  public:
+    explicit Buffer(TraceCompressor &compressor) : compressor(compressor) {}
+
+  protected:
+    virtual std::streamsize xsputn(const char *s, std::streamsize n);
+    virtual int_type overflow(int_type c);
+    virtual int sync();
+
+  private:
+    TraceCompressor &compressor;
+  };
+
+  std::ofstream file;
+  TraceCompressor compressor;
+  Buffer buffer;
+};
+
+/// \ingroup debug
+///
+/// \brief Write to os the binary trace compressed in is by TraceCompressor,
+/// and return its number of records. Data which is not compressed is
+/// copied. If the compressed data is truncated, for instance when the
+/// process writing it crashed, the complete records are written.
+DYNAMIC_GRAPH_DLLAPI std::size_t decompressTrace(std::istream &is,
+                                                 std::ostream &os);
+
+} // end of namespace dynamicgraph
+
+#endif //! DYNAMIC_GRAPH_TRACE_COMPRESSION_H
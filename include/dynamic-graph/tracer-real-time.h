@@ -5,7 +5,11 @@
 
 #ifndef DYNAMIC_GRAPH_TRACER_REAL_TIME_H
 #define DYNAMIC_GRAPH_TRACER_REAL_TIME_H
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 #include <dynamic-graph/config-tracer-real-time.hh>
 #include <dynamic-graph/fwd.hh>
@@ -15,6 +19,13 @@ namespace dynamicgraph {
 /// \ingroup plugin
 ///
 /// \brief Stream for the tracer real-time.
+///
+/// When the tracer writes the files in the background (see
+/// TracerRealTime::setAsynchronous()), the stream has a second buffer: the
+/// data is added to the first one while the second one is written.
+///
+/// When the files are mapped in memory (see TracerRealTime::mappedFiles),
+/// the buffer is a part of the file mapped in memory instead (see map()).
 class DG_TRACERREALTIME_DLLAPI OutStringStream : public std::ostringstream {
 public:
   char *buffer;
@@ -23,6 +34,31 @@ public:
   bool full;
   std::string givenname;
 
+  /// Buffer given to the writer by swap(), NULL if not allocated.
+  char *backBuffer;
+  std::streamsize backIndex;
+  /// True from swap() until the writer has written the buffer.
+  std::atomic<bool> backPending;
+  /// Set to have the buffers swapped at the next record (see
+  /// TracerRealTime::trace()).
+  std::atomic<bool> swapRequested;
+
+  /// Descriptor of the file mapped in buffer, -1 if it is not mapped.
+  int fd;
+  /// Position in the file of the part mapped in buffer.
+  std::streamoff mappedOffset;
+  /// Next part of the file, mapped in advance by prepareNext(), NULL if it
+  /// is not mapped yet.
+  char *nextPart;
+  /// Part replaced by mapNext(), unmapped by prepareNext().
+  char *retiredPart;
+  /// True once the file could not be extended: the parts are not mapped
+  /// again.
+  bool mapFailed;
+  /// Protects the parts against prepareNext(), which only holds it to
+  /// exchange them.
+  std::mutex mapMutex;
+
 public:
   OutStringStream();
   ~OutStringStream();
@@ -31,6 +67,29 @@ public:
   bool addData(const char *data, const std::streamoff &size);
   void dump(std::ostream &os);
   void empty();
+
+  /// Allocate the second buffer.
+  void enableDoubleBuffer();
+  /// Give the data added so far to the writer, by swapping the buffers.
+  /// Return false if the writer has not written the previous one yet.
+  bool swap();
+  /// Write the data given by swap(), if any.
+  void dumpBack(std::ostream &os);
+
+  /// Map the file filename in memory, in place of the buffer: the data is
+  /// added directly to the file, which is extended by parts of size bytes,
+  /// rounded to the size of the pages. Throw ExceptionTraces if the file
+  /// cannot be mapped.
+  void map(const std::string &filename, const std::streamsize &size);
+  /// Continue in the next part of the file, mapped in advance by
+  /// prepareNext() if possible. Return false if the file cannot be
+  /// extended, without trying again afterwards.
+  bool mapNext();
+  /// Map the next part of the file in advance, and unmap the previous one,
+  /// out of the thread adding the data (see TracerRealTime::trace()).
+  void prepareNext();
+  /// Unmap the file, and truncate it to the data added.
+  void unmap();
 };
 
 /// \ingroup plugin
@@ -41,7 +100,10 @@ class DG_TRACERREALTIME_DLLAPI TracerRealTime : public Tracer {
 
 public:
   TracerRealTime(const std::string &n);
-  virtual ~TracerRealTime() {}
+  virtual ~TracerRealTime() {
+    closeFiles();
+    stopWriter();
+  }
 
   virtual void closeFiles();
   virtual void trace();
@@ -52,21 +114,69 @@ public:
 
   void emptyBuffers();
 
+  /// Write the data directly in the files, mapped in memory, instead of
+  /// writing the buffers to the files in trace(). The files are extended
+  /// by parts of the size of the buffers, allocated on the disk and mapped
+  /// in advance by the background writer (see setAsynchronous()) or by
+  /// trace(), otherwise by record() when a part is full. The data is
+  /// written to the disk by the system. The data added is then in the files
+  /// even if the process crashes, followed by zeros up to the end of the
+  /// mapped parts. The compressed format is written as the binary one in
+  /// these files. Set before opening the files.
+  bool mappedFiles;
+
   void setBufferSize(const int &SIZE) { bufferSize = SIZE; }
 
   const int &getBufferSize() { return bufferSize; }
 
+  /// Write the files in a background thread: the thread calling record()
+  /// only swaps the buffers of a signal once they are half full, and
+  /// trace() only gives the buffers to the writer. The data can then be
+  /// traced continuously, without calling trace() to empty the buffers.
+  void setAsynchronous(const bool &async);
+  bool isAsynchronous() { return writerRunning.load(); }
+
 protected:
   virtual void openFile(const SignalBase<int> &sig,
                         const std::string &filename);
+  virtual void openStream(const std::string &filename);
+  /// All the formats, COMPRESSED included.
+  virtual bool supportsTraceFormat(const TraceFormat &) const { return true; }
 
   virtual void recordSignal(std::ostream &os, const SignalBase<int> &sig);
+  virtual bool recordHeader(std::ostream &os, const SignalBase<int> &sig);
+  virtual bool recordIndex(std::ostream &os);
+  virtual void recordRow(std::ostream &os);
 
-  typedef std::list<std::ofstream *> HardFileList;
+  typedef std::list<std::ostream *> HardFileList;
   static const int BUFFER_SIZE_DEFAULT = 1048576; //  1Mo
 
   int bufferSize;
   HardFileList hardFiles;
+
+  /// \name Background writer (see setAsynchronous()).
+  /// \{
+  static const int WRITER_PERIOD_MS = 10;
+  std::atomic<bool> writerRunning;
+  std::thread writer;
+  /// Protects the lists of files against the writer. Never taken by
+  /// record().
+  std::mutex writerMutex;
+  std::condition_variable writerCondition;
+
+  /// Buffer of the file os, throw if os is not one.
+  OutStringStream &getBuffer(std::ostream &os);
+  /// Add the data formatted in file to its buffer, and give it to the
+  /// writer if needed.
+  void addBufferedData(OutStringStream &file);
+
+  void startWriter();
+  void stopWriter();
+  void writerLoop();
+  /// Write the buffers given by swap(), and map the next parts of the
+  /// mapped files. Called with writerMutex locked.
+  void dumpBackBuffers();
+  /// \}
 };
 } // end of namespace dynamicgraph
 
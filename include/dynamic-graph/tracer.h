@@ -7,8 +7,11 @@
 #define DYNAMIC_GRAPH_TRACER_H
 #include <boost/function.hpp>
 #include <list>
+#include <map>
 #include <mutex>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include <dynamic-graph/entity.h>
 #include <dynamic-graph/exception-traces.h>
@@ -33,7 +36,8 @@ protected:
 public:
   enum TraceStyle {
     WHEN_SAID
-    /// Record, then trace to file only when said to.
+    /// Record, then trace to file only when said to (see trace()), e.g.
+    /// when replaying a long run offline (see ExecutionPlan::runBatch()).
     ,
     EACH_TIME
     /// Record and trace to file immediately.
@@ -45,6 +49,38 @@ public:
   static const TraceStyle TRACE_STYLE_DEFAULT = EACH_TIME;
   double frequency;
 
+  enum TraceFormat {
+    TEXT
+    /// One line per record: the time, then the value of the signal in text
+    /// (see signal_io::trace()).
+    ,
+    BINARY
+    /// A header describing the signal (see recordHeader()), then one raw
+    /// record per time: the time as an int32, followed by the data of the
+    /// value (see signal_binary_io::record()).
+    ,
+    COMPRESSED
+    /// The binary trace, compressed as it is written (see
+    /// TraceCompressor), and read back with decompressTrace(). Only the
+    /// TracerRealTime supports it: it compresses the records when it
+    /// writes its buffers to the files, in trace() or in its background
+    /// writer, whereas the Tracer writes them in record(), on the thread
+    /// recording them.
+  };
+  TraceFormat traceFormat;
+  static const TraceFormat TRACE_FORMAT_DEFAULT = TEXT;
+
+  /// Precision to which the floating-point numbers of the compressed traces
+  /// are rounded, 0 to keep them exactly (see TraceCompressor). Set before
+  /// opening the files.
+  double compressionPrecision;
+
+  /// Write all the signals in a single file, named by the basename and the
+  /// suffix only, with one row per record (see recordIndex() and
+  /// recordRow()), instead of one file per signal. Set before opening the
+  /// files.
+  bool singleFile;
+
   std::string basename;
   std::string suffix;
   std::string rootdir;
@@ -56,6 +92,22 @@ public:
   bool play;
   int timeStart;
 
+protected:
+  /// For each file, true once the header of the binary trace is written.
+  std::vector<bool> headerWritten;
+  /// Size of the binary records of each column of the files, measured when
+  /// their header is written, or VARIABLE_SIZE for the records prefixed by
+  /// their length. A record of another size, such as the one of a matrix
+  /// which changed size, is not written.
+  std::map<const std::ostream *, std::vector<std::streamsize> > recordSizes;
+  static const std::streamsize VARIABLE_SIZE = -1;
+  /// Buffer in which the binary records are formatted before being written
+  /// to the files, so that a signal which throws leaves no partial record.
+  std::stringstream recordBuffer;
+  /// Size of the binary records of sig, with the given format.
+  std::streamsize binaryRecordSize(const SignalBase<int> &sig,
+                                   const std::string &format);
+
 public:
   Tracer(const std::string n);
   virtual ~Tracer() { closeFiles(); }
@@ -73,6 +125,13 @@ public:
 protected:
   virtual void openFile(const SignalBase<int> &sig,
                         const std::string &filename);
+  /// Open the file named filename, and add it to the list of files.
+  virtual void openStream(const std::string &filename);
+  /// Whether the files can be written in the format: all the formats but
+  /// COMPRESSED for the Tracer.
+  virtual bool supportsTraceFormat(const TraceFormat &format) const {
+    return COMPRESSED != format;
+  }
 
 public:
   void setTraceStyle(const TraceStyle &style) { traceStyle = style; }
@@ -81,8 +140,31 @@ public:
   void setFrenquency(const double &frqu) { frequency = frqu; }
   double getFrequency() { return frequency; }
 
+  /// Set the format of the files. Throw ExceptionTraces if files are open
+  /// with another format, or if the tracer does not support the format
+  /// (see COMPRESSED).
+  void setTraceFormat(const TraceFormat &format);
+  TraceFormat getTraceFormat() { return traceFormat; }
+  /// Same, with the format named "text", "binary" or "compressed".
+  void setTraceFormatName(const std::string &format);
+  std::string getTraceFormatName();
+
   void record();
   virtual void recordSignal(std::ostream &os, const SignalBase<int> &sig);
+  /// Write the header of a binary trace: the string "dynamic-graph trace
+  /// 1", the name of the signal and the format of its records (see
+  /// SignalBase::getBinaryTraceFormat()), each prefixed by its length as
+  /// an uint32. Return false if the signal cannot be traced yet.
+  virtual bool recordHeader(std::ostream &os, const SignalBase<int> &sig);
+  /// In a single file, write the index of the columns: in text, a line
+  /// "# time" followed by the names of the signals separated by tabs. In
+  /// binary, the string "dynamic-graph multiplexed trace 1", the number of
+  /// signals as an uint32, then the name and the format of each signal (see
+  /// recordHeader()).
+  virtual bool recordIndex(std::ostream &os);
+  /// In a single file, write one row: the time of the first signal, then
+  /// the value of each signal, in the format of the traces.
+  virtual void recordRow(std::ostream &os);
   int &recordTrigger(int &dummy, const int &time);
 
   virtual void trace();
@@ -0,0 +1,72 @@
+// -*- mode: c++ -*-
+// Copyright 2020, LAAS-CNRS
+//
+
+#ifndef DYNAMIC_GRAPH_TRIPLE_BUFFER_H
+#define DYNAMIC_GRAPH_TRIPLE_BUFFER_H
+#include <atomic>
+
+#include <boost/noncopyable.hpp>
+
+namespace dynamicgraph {
+/// \ingroup dgraph
+///
+/// \brief Lock-free single producer, single consumer exchange of values.
+///
+/// The writer fills the back buffer and publishes it, the reader fetches
+/// the latest published buffer. None of them ever waits for the other:
+/// values published between two reads are dropped, and the reader always
+/// gets a complete value.
+///
+/// The content of the back buffer given to the writer is unspecified (it
+/// is a previously published or read value): it has to be fully written
+/// before being published.
+template <class T> class TripleBuffer : private boost::noncopyable {
+public:
+  TripleBuffer() : back(0), middle(1), front(2) {}
+
+  /// \name Writer side
+  /// \{
+  T &getBackBuffer() { return buffers[back]; }
+
+  /// Make the back buffer available to the reader.
+  void publish() {
+    back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+  }
+
+  void publish(const T &value) {
+    buffers[back] = value;
+    publish();
+  }
+  /// \}
+
+  /// \name Reader side
+  /// \{
+  /// Fetch the latest published buffer, if any.
+  /// \return true if a new value has been published since the last call.
+  bool update() {
+    if (!(middle.load(std::memory_order_relaxed) & FRESH))
+      return false;
+    front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+    return true;
+  }
+
+  T &getFrontBuffer() { return buffers[front]; }
+  /// \}
+
+private:
+  static const unsigned int INDEX = 3;
+  static const unsigned int FRESH = 4;
+
+  T buffers[3];
+  // Only accessed by the writer.
+  unsigned int back;
+  // Index of the buffer being exchanged, flagged FRESH when published.
+  std::atomic<unsigned int> middle;
+  // Only accessed by the reader.
+  unsigned int front;
+};
+
+} // end of namespace dynamicgraph
+
+#endif //! DYNAMIC_GRAPH_TRIPLE_BUFFER_H
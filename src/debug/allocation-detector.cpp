@@ -0,0 +1,152 @@
+/* Copyright 2020, LAAS-CNRS
+ *
+ * See LICENSE file in the root directory of this repository.
+ */
+
+#include <dynamic-graph/allocation-detector.h>
+
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#ifdef __GLIBC__
+#include <execinfo.h>
+#endif
+
+#ifdef __GNUC__
+// These variables are read by the allocation hooks: the initial-exec model
+// guarantees their access never allocates.
+#define DG_HOOK_TLS __attribute__((tls_model("initial-exec")))
+#else
+#define DG_HOOK_TLS
+#endif
+
+namespace dynamicgraph {
+
+namespace {
+const int STACK_DEPTH = 16;
+// Frames of AllocationDetector::record() and of the hook.
+const int STACK_SKIP = 2;
+
+typedef std::vector<void *> Stack;
+struct Record {
+  Record() : count(0), bytes(0) {}
+  std::size_t count;
+  std::size_t bytes;
+  std::map<Stack, std::size_t> stacks;
+};
+typedef std::map<std::string, Record> Records;
+
+std::mutex mutex;
+// Protected by mutex.
+Records records;
+std::size_t total = 0;
+
+// Signal being evaluated by the thread.
+thread_local const std::string *current DG_HOOK_TLS = NULL;
+// Set while an allocation is being recorded, to ignore the allocations of
+// the detector itself.
+thread_local bool recording DG_HOOK_TLS = false;
+
+// Name of the entity, in a signal name of the form "Class(entity)::...".
+std::string entityName(const std::string &signal) {
+  const std::size_t begin = signal.find('(');
+  const std::size_t end = signal.find(')');
+  if (begin == std::string::npos || end == std::string::npos || end < begin)
+    return "";
+  return signal.substr(begin + 1, end - begin - 1);
+}
+} // namespace
+
+std::atomic<bool> AllocationDetector::enabled(false);
+
+const std::string *AllocationDetector::enter(const std::string *name) {
+  const std::string *previous = current;
+  current = name;
+  return previous;
+}
+
+void AllocationDetector::leave(const std::string *previous) {
+  current = previous;
+}
+
+void AllocationDetector::record(const std::size_t &size) {
+  if (!isEnabled() || NULL == current || recording)
+    return;
+  recording = true;
+  Stack stack;
+#ifdef __GLIBC__
+  void *frames[STACK_DEPTH];
+  const int n = backtrace(frames, STACK_DEPTH);
+  if (n > STACK_SKIP)
+    stack.assign(frames + STACK_SKIP, frames + n);
+#endif
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    Record &record = records[*current];
+    ++record.count;
+    record.bytes += size;
+    ++record.stacks[stack];
+    ++total;
+  }
+  recording = false;
+}
+
+void AllocationDetector::clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+  records.clear();
+  total = 0;
+}
+
+std::size_t AllocationDetector::getNbAllocations() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return total;
+}
+
+void AllocationDetector::report(std::ostream &os) {
+  // The allocations of the report itself must not be recorded.
+  const bool wasRecording = recording;
+  recording = true;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<std::string, std::vector<Records::const_iterator> > entities;
+    for (Records::const_iterator it = records.begin(); it != records.end();
+         ++it)
+      entities[entityName(it->first)].push_back(it);
+
+    os << total << " allocations during the evaluation of signals."
+       << std::endl;
+    for (std::map<std::string,
+                  std::vector<Records::const_iterator> >::const_iterator ent =
+             entities.begin();
+         ent != entities.end(); ++ent) {
+      os << "Entity " << (ent->first.empty() ? "-" : ent->first) << std::endl;
+      for (std::size_t i = 0; i < ent->second.size(); ++i) {
+        const Record &record = ent->second[i]->second;
+        os << "  " << ent->second[i]->first << ": " << record.count
+           << " allocations, " << record.bytes << " bytes" << std::endl;
+        for (std::map<Stack, std::size_t>::const_iterator st =
+                 record.stacks.begin();
+             st != record.stacks.end(); ++st) {
+          os << "    " << st->second << " at:" << std::endl;
+          if (st->first.empty())
+            continue;
+#ifdef __GLIBC__
+          char **symbols = backtrace_symbols(
+              &st->first[0], static_cast<int>(st->first.size()));
+          for (std::size_t f = 0; symbols != NULL && f < st->first.size(); ++f)
+            os << "      " << symbols[f] << std::endl;
+          std::free(symbols);
+#else
+          for (std::size_t f = 0; f < st->first.size(); ++f)
+            os << "      " << st->first[f] << std::endl;
+#endif
+        }
+      }
+    }
+  }
+  recording = wasRecording;
+}
+
+} // namespace dynamicgraph
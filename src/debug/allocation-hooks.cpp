@@ -0,0 +1,44 @@
+/* Copyright 2020, LAAS-CNRS
+ *
+ * See LICENSE file in the root directory of this repository.
+ */
+
+// Replacements of the allocation functions of the C library, which report
+// each allocation to the AllocationDetector. They are in their own library
+// so that only the programs linked with it (or preloading it) pay for the
+// interception. Operator new and Eigen both allocate through malloc.
+
+#include <dynamic-graph/allocation-detector.h>
+
+#include <cstddef>
+
+bool dynamicgraph::AllocationDetector::hasHooks() {
+#ifdef __GLIBC__
+  return true;
+#else
+  return false;
+#endif
+}
+
+#ifdef __GLIBC__
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t n, std::size_t size);
+void *__libc_realloc(void *ptr, std::size_t size);
+
+void *malloc(std::size_t size) {
+  dynamicgraph::AllocationDetector::record(size);
+  return __libc_malloc(size);
+}
+
+void *calloc(std::size_t n, std::size_t size) {
+  dynamicgraph::AllocationDetector::record(n * size);
+  return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, std::size_t size) {
+  dynamicgraph::AllocationDetector::record(size);
+  return __libc_realloc(ptr, size);
+}
+}
+#endif
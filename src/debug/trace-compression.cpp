@@ -0,0 +1,598 @@
+/* Copyright 2020, LAAS-CNRS
+ *
+ * See LICENSE file in the root directory of this repository.
+ */
+
+#include <dynamic-graph/exception-traces.h>
+#include <dynamic-graph/signal-binary-io.h>
+#include <dynamic-graph/trace-compression.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace dynamicgraph {
+
+namespace {
+const char *const BINARY_MAGIC = "dynamic-graph trace 1";
+const char *const MULTIPLEXED_MAGIC = "dynamic-graph multiplexed trace 1";
+const char *const COMPRESSED_MAGIC = "dynamic-graph compressed trace 1";
+const char *const QUANTIZED_MAGIC = "dynamic-graph quantized trace 1";
+
+// Largest multiple of the precision which is rounded: the integers up to
+// 2^53 are exact in a float64.
+const double MAX_QUANTIZED = 9007199254740992.;
+// Number of bits of the difference of the successive differences of the
+// rounded numbers, given by the number of 1 before a 0. Five 1 are
+// followed by a number kept exactly.
+const int QUANTIZED_BITS[] = {3, 7, 12, 64};
+const int QUANTIZED_EXACT = 5;
+
+typedef TraceCompressor::Column Column;
+
+Column makeColumn(const bool &isFloat, const bool &isSigned,
+                  const unsigned int &size) {
+  Column column;
+  column.isFloat = isFloat;
+  column.isSigned = isSigned;
+  column.size = size;
+  column.precision = 0.;
+  column.first = true;
+  column.previous = 0;
+  column.previousDelta = 0;
+  column.leading = -1;
+  column.trailing = 0;
+  return column;
+}
+
+// Add the columns of a value of the given format, such as float64[3x1].
+// Return false if its records do not have a fixed size.
+bool addColumns(const std::string &format, std::vector<Column> &columns) {
+  const std::size_t bracket = format.find('[');
+  const std::string scalar = format.substr(0, bracket);
+  std::size_t count = 1;
+  if (std::string::npos != bracket) {
+    std::istringstream dims(format.substr(bracket + 1));
+    std::size_t rows = 0, cols = 0;
+    char x = 0;
+    dims >> rows >> x >> cols;
+    if (dims.fail() || 'x' != x)
+      return false;
+    count = rows * cols;
+  }
+
+  bool isFloat = false, isSigned = false;
+  std::string bits;
+  if (0 == scalar.compare(0, 5, "float")) {
+    isFloat = true;
+    bits = scalar.substr(5);
+  } else if (0 == scalar.compare(0, 4, "uint")) {
+    bits = scalar.substr(4);
+  } else if (0 == scalar.compare(0, 3, "int")) {
+    isSigned = true;
+    bits = scalar.substr(3);
+  } else {
+    return false;
+  }
+  const int nbBits = std::atoi(bits.c_str());
+  if (isFloat ? (32 != nbBits && 64 != nbBits)
+              : (8 != nbBits && 16 != nbBits && 32 != nbBits && 64 != nbBits))
+    return false;
+  for (std::size_t i = 0; i < count; ++i)
+    columns.push_back(
+        makeColumn(isFloat, isSigned, static_cast<unsigned int>(nbBits / 8)));
+  return true;
+}
+
+// Value of a column, extended to 64 bits.
+std::uint64_t load(const Column &column, const char *data) {
+  if (column.isFloat) {
+    if (4 == column.size) {
+      std::uint32_t bits;
+      std::memcpy(&bits, data, 4);
+      return bits;
+    }
+    std::uint64_t bits;
+    std::memcpy(&bits, data, 8);
+    return bits;
+  }
+  switch (column.size) {
+  case 1: {
+    std::uint8_t v;
+    std::memcpy(&v, data, 1);
+    return column.isSigned ? static_cast<std::uint64_t>(
+                                 static_cast<std::int64_t>(std::int8_t(v)))
+                           : v;
+  }
+  case 2: {
+    std::uint16_t v;
+    std::memcpy(&v, data, 2);
+    return column.isSigned ? static_cast<std::uint64_t>(
+                                 static_cast<std::int64_t>(std::int16_t(v)))
+                           : v;
+  }
+  case 4: {
+    std::uint32_t v;
+    std::memcpy(&v, data, 4);
+    return column.isSigned ? static_cast<std::uint64_t>(
+                                 static_cast<std::int64_t>(std::int32_t(v)))
+                           : v;
+  }
+  default: {
+    std::uint64_t v;
+    std::memcpy(&v, data, 8);
+    return v;
+  }
+  }
+}
+
+// Inverse of load().
+void store(const Column &column, const std::uint64_t &value, char *data) {
+  switch (column.size) {
+  case 1: {
+    const std::uint8_t v = static_cast<std::uint8_t>(value);
+    std::memcpy(data, &v, 1);
+    break;
+  }
+  case 2: {
+    const std::uint16_t v = static_cast<std::uint16_t>(value);
+    std::memcpy(data, &v, 2);
+    break;
+  }
+  case 4: {
+    const std::uint32_t v = static_cast<std::uint32_t>(value);
+    std::memcpy(data, &v, 4);
+    break;
+  }
+  default:
+    std::memcpy(data, &value, 8);
+  }
+}
+
+int leadingZeros(const std::uint64_t &x, const int &width) {
+  int n = 0;
+  for (int bit = width - 1; bit >= 0 && !((x >> bit) & 1); --bit)
+    ++n;
+  return n;
+}
+
+int trailingZeros(const std::uint64_t &x) {
+  int n = 0;
+  while (n < 64 && !((x >> n) & 1))
+    ++n;
+  return n;
+}
+
+// Floating-point number of a column, from its bits.
+double toDouble(const Column &column, const std::uint64_t &bits) {
+  if (4 == column.size) {
+    const std::uint32_t bits32 = static_cast<std::uint32_t>(bits);
+    float f;
+    std::memcpy(&f, &bits32, 4);
+    return f;
+  }
+  double d;
+  std::memcpy(&d, &bits, 8);
+  return d;
+}
+
+// Inverse of toDouble().
+std::uint64_t fromDouble(const Column &column, const double &value) {
+  if (4 == column.size) {
+    const float f = static_cast<float>(value);
+    std::uint32_t bits32;
+    std::memcpy(&bits32, &f, 4);
+    return bits32;
+  }
+  std::uint64_t bits;
+  std::memcpy(&bits, &value, 8);
+  return bits;
+}
+
+inline std::uint64_t mask(const int &nbBits) {
+  return (nbBits >= 64) ? ~std::uint64_t(0)
+                        : ((std::uint64_t(1) << nbBits) - 1);
+}
+
+// Reader of the encoded data, bit by bit.
+class BitReader {
+public:
+  explicit BitReader(std::istream &is) : is(is), current(0), left(0) {}
+
+  bool get(const int &nbBits, std::uint64_t &value) {
+    value = 0;
+    int n = nbBits;
+    while (n > 0) {
+      if (0 == left) {
+        const int c = is.get();
+        if (std::char_traits<char>::eof() == c)
+          return false;
+        current = static_cast<unsigned char>(c);
+        left = 8;
+      }
+      const int take = (n < left) ? n : left;
+      value = (value << take) | ((current >> (left - take)) & mask(take));
+      left -= take;
+      n -= take;
+    }
+    return true;
+  }
+
+private:
+  std::istream &is;
+  unsigned char current;
+  int left;
+};
+
+// Decode the value of a column, inverse of TraceCompressor::encode().
+bool decode(BitReader &bits, Column &column, std::uint64_t &value) {
+  const int width = static_cast<int>(8 * column.size);
+  std::uint64_t b;
+  if (column.isFloat && column.precision > 0) {
+    int ones = 0;
+    for (; ones < QUANTIZED_EXACT; ++ones) {
+      if (!bits.get(1, b))
+        return false;
+      if (0 == b)
+        break;
+    }
+    if (QUANTIZED_EXACT == ones)
+      return bits.get(width, value);
+    std::uint64_t zigzag = 0;
+    if (0 != ones && !bits.get(QUANTIZED_BITS[ones - 1], zigzag))
+      return false;
+    const std::uint64_t dod = (zigzag >> 1) ^ (0 - (zigzag & 1));
+    column.previousDelta += dod;
+    column.previous += column.previousDelta;
+    value = fromDouble(column,
+                       static_cast<double>(
+                           static_cast<std::int64_t>(column.previous)) *
+                           column.precision);
+    return true;
+  }
+
+  if (column.first) {
+    if (!bits.get(width, value))
+      return false;
+    column.first = false;
+    if (column.isSigned && width < 64 && ((value >> (width - 1)) & 1))
+      value |= ~mask(width);
+    column.previous = value;
+    return true;
+  }
+
+  if (column.isFloat) {
+    if (!bits.get(1, b))
+      return false;
+    std::uint64_t x = 0;
+    if (1 == b) {
+      if (!bits.get(1, b))
+        return false;
+      if (1 == b) {
+        std::uint64_t leading, length;
+        if (!bits.get(5, leading) || !bits.get(6, length))
+          return false;
+        column.leading = static_cast<int>(leading);
+        column.trailing = width - column.leading - static_cast<int>(length) - 1;
+      }
+      const int length = width - column.leading - column.trailing;
+      if (!bits.get(length, x))
+        return false;
+      x <<= column.trailing;
+    }
+    value = column.previous ^ x;
+  } else {
+    // The number of bits of the value is given by the number of 1 before a
+    // 0, except for the last size.
+    static const int NB_BITS[] = {7, 9, 12, 64};
+    int nbBits = 0;
+    for (int i = 0; i < 4; ++i) {
+      if (!bits.get(1, b))
+        return false;
+      if (0 == b)
+        break;
+      nbBits = NB_BITS[i];
+    }
+    std::uint64_t zigzag = 0;
+    if (0 != nbBits && !bits.get(nbBits, zigzag))
+      return false;
+    const std::uint64_t dod = (zigzag >> 1) ^ (0 - (zigzag & 1));
+    column.previousDelta += dod;
+    value = column.previous + column.previousDelta;
+  }
+  column.previous = value;
+  return true;
+}
+} // namespace
+
+TraceCompressor::TraceCompressor(std::ostream &os, const double &precision)
+    : os(os), precision(precision), state(HEADER), recordSize(0), current(0),
+      used(0) {}
+
+void TraceCompressor::setPrecision(std::vector<Column> &columns,
+                                   const double &precision) {
+  for (std::size_t i = 0; i < columns.size(); ++i) {
+    if (!columns[i].isFloat)
+      continue;
+    columns[i].precision = precision;
+    // The rounded numbers start from 0 rather than from a first value.
+    columns[i].first = !(precision > 0);
+  }
+}
+
+bool TraceCompressor::readHeader(std::istream &is, std::ostream &header,
+                                 std::vector<Column> &columns) {
+  const std::string magic = binary::readString(is);
+  binary::writeString(header, magic);
+  std::uint32_t nbSignals = 1;
+  if (MULTIPLEXED_MAGIC == magic) {
+    nbSignals = binary::read<std::uint32_t>(is);
+    binary::write(header, nbSignals);
+  } else if (BINARY_MAGIC != magic) {
+    return false;
+  }
+
+  // The time.
+  columns.push_back(makeColumn(false, true, 4));
+  bool fixed = true;
+  for (std::uint32_t i = 0; i < nbSignals; ++i) {
+    const std::string name = binary::readString(is);
+    const std::string format = binary::readString(is);
+    binary::writeString(header, name);
+    binary::writeString(header, format);
+    fixed = addColumns(format, columns) && fixed;
+  }
+  return fixed;
+}
+
+void TraceCompressor::write(const char *data, const std::streamsize &size) {
+  if (FINISHED == state)
+    DG_THROW ExceptionTraces(ExceptionTraces::GENERIC,
+                             "The compressed trace is finished", "");
+  if (COPY == state) {
+    os.write(data, size);
+    return;
+  }
+  pending.append(data, static_cast<std::size_t>(size));
+
+  if (HEADER == state) {
+    std::istringstream is(pending);
+    std::ostringstream header;
+    bool fixed = false;
+    try {
+      fixed = readHeader(is, header, columns);
+    } catch (const ExceptionSignal &) {
+      // Incomplete header.
+      columns.clear();
+      return;
+    }
+    if (!fixed) {
+      state = COPY;
+      os.write(pending.data(), static_cast<std::streamsize>(pending.size()));
+      pending.clear();
+      return;
+    }
+    if (precision > 0) {
+      binary::writeString(os, QUANTIZED_MAGIC);
+      binary::write<double>(os, precision);
+      setPrecision(columns, precision);
+    } else {
+      binary::writeString(os, COMPRESSED_MAGIC);
+    }
+    const std::string text = header.str();
+    os.write(text.data(), static_cast<std::streamsize>(text.size()));
+    pending.erase(0, text.size());
+    recordSize = 0;
+    for (std::size_t i = 0; i < columns.size(); ++i)
+      recordSize += columns[i].size;
+    state = COMPRESS;
+  }
+
+  std::size_t index = 0;
+  for (; index + recordSize <= pending.size(); index += recordSize)
+    encode(pending.data() + index);
+  pending.erase(0, index);
+  os.write(out.data(), static_cast<std::streamsize>(out.size()));
+  out.clear();
+}
+
+void TraceCompressor::finish() {
+  if (COMPRESS == state) {
+    // End of the records, and of the last byte.
+    put(0, 1);
+    if (0 != used)
+      put(0, 8 - used);
+    os.write(out.data(), static_cast<std::streamsize>(out.size()));
+    out.clear();
+  } else if (HEADER == state) {
+    os.write(pending.data(), static_cast<std::streamsize>(pending.size()));
+  }
+  pending.clear();
+  state = FINISHED;
+  os.flush();
+}
+
+void TraceCompressor::put(const std::uint64_t &value, const int &nbBits) {
+  int n = nbBits;
+  while (n > 0) {
+    const int space = 8 - used;
+    const int take = (n < space) ? n : space;
+    const unsigned int chunk =
+        static_cast<unsigned int>((value >> (n - take)) & mask(take));
+    current = static_cast<unsigned char>(current | (chunk << (space - take)));
+    used += take;
+    n -= take;
+    if (8 == used) {
+      out.push_back(static_cast<char>(current));
+      current = 0;
+      used = 0;
+    }
+  }
+}
+
+void TraceCompressor::encode(const char *record) {
+  // A record follows.
+  put(1, 1);
+  for (std::size_t i = 0; i < columns.size(); ++i) {
+    Column &column = columns[i];
+    const int width = static_cast<int>(8 * column.size);
+    const std::uint64_t value = load(column, record);
+    record += column.size;
+
+    if (column.isFloat && column.precision > 0) {
+      encodeQuantized(column, value);
+      continue;
+    }
+    if (column.first) {
+      put(value, width);
+      column.first = false;
+    } else if (column.isFloat) {
+      // The bits which changed, in the window of the previous value if they
+      // fit in it.
+      const std::uint64_t x = value ^ column.previous;
+      if (0 == x) {
+        put(0, 1);
+      } else {
+        int leading = leadingZeros(x, width);
+        if (leading > 31)
+          leading = 31;
+        const int trailing = trailingZeros(x);
+        if (column.leading >= 0 && leading >= column.leading &&
+            trailing >= column.trailing) {
+          put(2, 2);
+        } else {
+          put(3, 2);
+          put(static_cast<std::uint64_t>(leading), 5);
+          put(static_cast<std::uint64_t>(width - leading - trailing - 1), 6);
+          column.leading = leading;
+          column.trailing = trailing;
+        }
+        put(x >> column.trailing, width - column.leading - column.trailing);
+      }
+    } else {
+      // The difference of the successive differences.
+      const std::uint64_t delta = value - column.previous;
+      const std::uint64_t dod = delta - column.previousDelta;
+      const std::uint64_t zigzag =
+          (dod << 1) ^ (0 - (dod >> 63));
+      if (0 == zigzag) {
+        put(0, 1);
+      } else if (zigzag < (1u << 7)) {
+        put(2, 2);
+        put(zigzag, 7);
+      } else if (zigzag < (1u << 9)) {
+        put(6, 3);
+        put(zigzag, 9);
+      } else if (zigzag < (1u << 12)) {
+        put(14, 4);
+        put(zigzag, 12);
+      } else {
+        put(15, 4);
+        put(zigzag, 64);
+      }
+      column.previousDelta = delta;
+    }
+    column.previous = value;
+  }
+}
+
+void TraceCompressor::encodeQuantized(Column &column,
+                                      const std::uint64_t &value) {
+  const double scaled = toDouble(column, value) / column.precision;
+  // Also true for not-a-number.
+  if (!(std::fabs(scaled) < MAX_QUANTIZED)) {
+    put(mask(QUANTIZED_EXACT), QUANTIZED_EXACT);
+    put(value, static_cast<int>(8 * column.size));
+    return;
+  }
+  // The difference of the successive differences of the multiples of the
+  // precision.
+  const std::uint64_t rounded =
+      static_cast<std::uint64_t>(static_cast<std::int64_t>(
+          std::floor(scaled + 0.5)));
+  const std::uint64_t delta = rounded - column.previous;
+  const std::uint64_t dod = delta - column.previousDelta;
+  const std::uint64_t zigzag = (dod << 1) ^ (0 - (dod >> 63));
+  if (0 == zigzag) {
+    put(0, 1);
+  } else {
+    int i = 0;
+    while (i < 3 && zigzag >= (std::uint64_t(1) << QUANTIZED_BITS[i]))
+      ++i;
+    // i + 1 times 1, then 0.
+    put(mask(i + 1) << 1, i + 2);
+    put(zigzag, QUANTIZED_BITS[i]);
+  }
+  column.previousDelta = delta;
+  column.previous = rounded;
+}
+
+std::streamsize CompressedTraceFile::Buffer::xsputn(const char *s,
+                                                    std::streamsize n) {
+  compressor.write(s, n);
+  return n;
+}
+
+CompressedTraceFile::Buffer::int_type
+CompressedTraceFile::Buffer::overflow(int_type c) {
+  if (!traits_type::eq_int_type(c, traits_type::eof())) {
+    const char ch = traits_type::to_char_type(c);
+    compressor.write(&ch, 1);
+  }
+  return traits_type::not_eof(c);
+}
+
+int CompressedTraceFile::Buffer::sync() { return 0; }
+
+CompressedTraceFile::CompressedTraceFile(const std::string &filename,
+                                         const double &precision)
+    : std::ostream(NULL),
+      file(filename.c_str(), std::ios::out | std::ios::binary),
+      compressor(file, precision), buffer(compressor) {
+  rdbuf(&buffer);
+  if (!file.good())
+    setstate(std::ios::badbit);
+}
+
+CompressedTraceFile::~CompressedTraceFile() { compressor.finish(); }
+
+std::size_t decompressTrace(std::istream &is, std::ostream &os) {
+  const std::string magic = binary::readString(is);
+  if (COMPRESSED_MAGIC != magic && QUANTIZED_MAGIC != magic) {
+    binary::writeString(os, magic);
+    os << is.rdbuf();
+    return 0;
+  }
+  const double precision =
+      (QUANTIZED_MAGIC == magic) ? binary::read<double>(is) : 0.;
+
+  std::vector<Column> columns;
+  if (!TraceCompressor::readHeader(is, os, columns))
+    DG_THROW ExceptionTraces(ExceptionTraces::GENERIC,
+                             "Invalid header of compressed trace", "");
+  TraceCompressor::setPrecision(columns, precision);
+  std::size_t recordSize = 0;
+  for (std::size_t i = 0; i < columns.size(); ++i)
+    recordSize += columns[i].size;
+
+  BitReader bits(is);
+  std::vector<char> record(recordSize);
+  std::size_t nbRecords = 0;
+  std::uint64_t more;
+  while (bits.get(1, more) && 1 == more) {
+    char *data = record.data();
+    for (std::size_t i = 0; i < columns.size(); ++i) {
+      std::uint64_t value;
+      if (!decode(bits, columns[i], value))
+        return nbRecords;
+      store(columns[i], value, data);
+      data += columns[i].size;
+    }
+    os.write(record.data(), static_cast<std::streamsize>(recordSize));
+    ++nbRecords;
+  }
+  return nbRecords;
+}
+
+} // namespace dynamicgraph
@@ -0,0 +1,125 @@
+/* Copyright 2020, LAAS-CNRS
+ *
+ * See LICENSE file in the root directory of this repository.
+ */
+
+#include <dynamic-graph/arena.h>
+#include <dynamic-graph/pool.h>
+
+#include <cstdint>
+#include <new>
+
+namespace dynamicgraph {
+
+namespace {
+// Alignment of all the allocations.
+const std::size_t ALIGNMENT = alignof(std::max_align_t);
+
+inline std::size_t align(const std::size_t &size) {
+  return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+// Padding to add to ptr to align it on alignment.
+inline std::size_t padding(const char *ptr, const std::size_t &alignment) {
+  return (alignment - reinterpret_cast<std::uintptr_t>(ptr) % alignment) %
+         alignment;
+}
+} // namespace
+
+const std::size_t Arena::DEFAULT_BLOCK_SIZE;
+
+Arena::Arena(std::size_t blockSize)
+    : blockSize(align(blockSize)), current(NULL), remaining(0), size(0) {}
+
+Arena::~Arena() {
+  for (std::map<const char *, std::size_t>::const_iterator it = blocks.begin();
+       it != blocks.end(); ++it)
+    ::operator delete(const_cast<char *>(it->first));
+}
+
+void *Arena::allocate(std::size_t n, std::size_t alignment) {
+  if (alignment < ALIGNMENT)
+    alignment = ALIGNMENT;
+  n = align(n == 0 ? 1 : n);
+  // The blocks are aligned on ALIGNMENT: the worst padding is the rest.
+  const std::size_t worst = n + alignment - ALIGNMENT;
+  std::lock_guard<std::mutex> lock(mutex);
+  size += n;
+  if (worst > blockSize) {
+    // Keep filling the current block.
+    char *block = static_cast<char *>(::operator new(worst));
+    blocks[block] = worst;
+    return block + padding(block, alignment);
+  }
+  std::size_t pad = padding(current, alignment);
+  if (NULL == current || pad + n > remaining) {
+    current = static_cast<char *>(::operator new(blockSize));
+    blocks[current] = blockSize;
+    remaining = blockSize;
+    pad = padding(current, alignment);
+  }
+  void *ptr = current + pad;
+  current += pad + n;
+  remaining -= pad + n;
+  return ptr;
+}
+
+bool Arena::contains(const void *ptr) const {
+  const char *p = static_cast<const char *>(ptr);
+  std::lock_guard<std::mutex> lock(mutex);
+  std::map<const char *, std::size_t>::const_iterator it =
+      blocks.upper_bound(p);
+  if (blocks.begin() == it)
+    return false;
+  --it;
+  return p < it->first + it->second;
+}
+
+std::size_t Arena::getSize() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return size;
+}
+
+std::size_t Arena::getNbBlocks() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return blocks.size();
+}
+
+void *ArenaAllocated::operator new(std::size_t size) {
+  Arena *arena = PoolStorage::getArena();
+  return NULL != arena ? arena->allocate(size) : ::operator new(size);
+}
+
+void *ArenaAllocated::operator new(std::size_t size,
+                                   const std::nothrow_t &) noexcept {
+  try {
+    return ArenaAllocated::operator new(size);
+  } catch (const std::bad_alloc &) {
+    return NULL;
+  }
+}
+
+void ArenaAllocated::operator delete(void *ptr) {
+  // The memory of the arena is only freed with it.
+  Arena *arena = PoolStorage::getArena();
+  if (NULL == arena || !arena->contains(ptr))
+    ::operator delete(ptr);
+}
+
+#ifdef __cpp_aligned_new
+void *ArenaAllocated::operator new(std::size_t size,
+                                   std::align_val_t alignment) {
+  Arena *arena = PoolStorage::getArena();
+  return NULL != arena
+             ? arena->allocate(size, static_cast<std::size_t>(alignment))
+             : ::operator new(size, alignment);
+}
+
+void ArenaAllocated::operator delete(void *ptr, std::align_val_t alignment) {
+  Arena *arena = PoolStorage::getArena();
+  if (NULL == arena || !arena->contains(ptr))
+    ::operator delete(ptr, alignment);
+}
+#endif
+
+} // namespace dynamicgraph
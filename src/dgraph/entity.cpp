@@ -29,7 +29,7 @@ void Entity::entityDeregistration() {
   PoolStorage::getInstance()->deregisterEntity(name);
 }
 
-Entity::Entity(const string &name__) : name(name__) {
+Entity::Entity(const string &name__) : name(name__), signalsChanged(true) {
   dgDEBUG(15) << "New entity <" << name__ << ">" << endl;
   if (name.length() == 0) {
     stringstream oss;
@@ -56,22 +56,18 @@ Entity::~Entity() {
 /* --- SIGNALS -------------------------------------------------------------- */
 /* -------------------------------------------------------------------------- */
 void Entity::signalRegistration(const SignalArray<int> &signals) {
+  bool registered = false;
   for (unsigned int i = 0; i < signals.getSize(); ++i) {
     SignalBase<int> &sig = signals[i];
-    // const string& signame = sig.getName ();
-    istringstream iss(sig.getName());
-    const int SIZE = 128;
-    char buffer[SIZE];
-    while (iss.good()) {
-      iss.getline(buffer, SIZE, ':');
-    }
-    const string &signame(buffer);
+    const string signame(sig.shortName());
 
-    SignalMap::iterator sigkey = signalMap.find(signame);
-    if (sigkey != signalMap.end()) // key does exist
+    SignalIndex::iterator sigkey = signalIndex.find(signame);
+    if (sigkey != signalIndex.end()) // key does exist
     {
       dgERRORF("Key %s already exist in the signalMap.", signame.c_str());
       if (sigkey->second != &sig) {
+        if (registered)
+          PoolStorage::notifyRegistryChange();
         throw ExceptionFactory(
             ExceptionFactory::SIGNAL_CONFLICT,
             "Another signal already defined with the same name. ",
@@ -80,14 +76,22 @@ void Entity::signalRegistration(const SignalArray<int> &signals) {
     } else {
       dgDEBUG(10) << "Register signal <" << signame << "> for entity <"
                   << getName() << "> ." << endl;
-      signalMap[signame] = &sig;
+      {
+        std::lock_guard<std::mutex> lock(signalsMutex);
+        signalMap[signame] = &sig;
+        signalsChanged.store(true, std::memory_order_release);
+      }
+      signalIndex[signame] = &sig;
+      registered = true;
     }
   }
+  if (registered)
+    PoolStorage::notifyRegistryChange();
 }
 
 void Entity::signalDeregistration(const std::string &signame) {
-  SignalMap::iterator sigkey = signalMap.find(signame);
-  if (sigkey == signalMap.end()) // key does not exist
+  SignalIndex::iterator sigkey = signalIndex.find(signame);
+  if (sigkey == signalIndex.end()) // key does not exist
   {
     dgERRORF("Key %s does not exist in the signalMap.", signame.c_str());
     throw ExceptionFactory(ExceptionFactory::UNREFERED_SIGNAL,
@@ -96,18 +100,38 @@ void Entity::signalDeregistration(const std::string &signame) {
   } else {
     dgDEBUG(10) << "Deregister signal <" << signame << "> for entity <"
                 << getName() << "> ." << endl;
-    signalMap.erase(signame);
+    signalIndex.erase(sigkey);
+    {
+      std::lock_guard<std::mutex> lock(signalsMutex);
+      signalMap.erase(signame);
+      signalsChanged.store(true, std::memory_order_release);
+    }
+    PoolStorage::notifyRegistryChange();
   }
 }
 
+Entity::SignalMapSnapshot Entity::getSignalSnapshot() const {
+  // The map is only copied once after a series of changes.
+  if (signalsChanged.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(signalsMutex);
+    if (signalsChanged.load(std::memory_order_relaxed)) {
+      std::atomic_store(
+          &signalSnapshot,
+          SignalMapSnapshot(std::make_shared<SignalMap>(signalMap)));
+      signalsChanged.store(false, std::memory_order_relaxed);
+    }
+  }
+  return std::atomic_load(&signalSnapshot);
+}
+
 std::string Entity::getDocString() const {
   std::string docString("No header documentation.");
   return docString;
 }
 
 #define __DG_ENTITY_GET_SIGNAL__(ITER_TYPE)                                    \
-  SignalMap::ITER_TYPE sigkey = signalMap.find(signame);                       \
-  if (sigkey == signalMap.end()) /* key does NOT exist */                      \
+  SignalIndex::ITER_TYPE sigkey = signalIndex.find(signame);                   \
+  if (sigkey == signalIndex.end()) /* key does NOT exist */                    \
   {                                                                            \
     throw ExceptionFactory(ExceptionFactory::UNREFERED_SIGNAL,                 \
                            "The requested signal is not registered", ": %s",   \
@@ -116,7 +140,7 @@ std::string Entity::getDocString() const {
   return *(sigkey->second);
 
 bool Entity::hasSignal(const string &signame) const {
-  return (!(signalMap.find(signame) == signalMap.end()));
+  return (!(signalIndex.find(signame) == signalIndex.end()));
 }
 
 SignalBase<int> &Entity::getSignal(const string &signame) {
@@ -162,6 +186,30 @@ std::ostream &Entity::writeCompletionList(std::ostream &os) const {
   return os;
 }
 
+std::ostream &Entity::writeProfile(std::ostream &os) const {
+  unsigned long nbCalls = 0, nbRecomputes = 0, nbCacheHits = 0;
+  double totalTime = 0., maxTime = 0.;
+  const SignalMap::const_iterator iterend = signalMap.end();
+  for (SignalMap::const_iterator iter = signalMap.begin(); iterend != iter;
+       ++iter) {
+    const SignalProfile &profile = iter->second->getProfile();
+    nbCalls += profile.getNbCalls();
+    nbRecomputes += profile.getNbRecomputes();
+    nbCacheHits += profile.getNbCacheHits();
+    totalTime += profile.getTotalTime();
+    maxTime = std::max(maxTime, profile.getMaxTime());
+  }
+  os << getName() << ": calls=" << nbCalls << " recomputes=" << nbRecomputes
+     << " cacheHits=" << nbCacheHits << " total=" << totalTime
+     << "s max=" << maxTime << "s" << std::endl;
+  for (SignalMap::const_iterator iter = signalMap.begin(); iterend != iter;
+       ++iter) {
+    os << "  " << iter->first << ": ";
+    iter->second->getProfile().display(os) << std::endl;
+  }
+  return os;
+}
+
 void Entity::display(std::ostream &os) const {
   os << this->getClassName() << ": " << name;
 }
@@ -13,8 +13,12 @@
 
 /* --- DYNAMIC-GRAPH --- */
 #include "dynamic-graph/pool.h"
+#include "dynamic-graph/allocation-detector.h"
 #include "dynamic-graph/debug.h"
 #include "dynamic-graph/entity.h"
+#include "dynamic-graph/factory.h"
+#include "dynamic-graph/signal-binary-io.h"
+#include <cstdint>
 #include <list>
 #include <sstream>
 #include <string>
@@ -47,17 +51,27 @@ PoolStorage::~PoolStorage() {
        iter = entityMap.begin()) {
     dgDEBUG(15) << "Delete \"" << (iter->first) << "\"" << std::endl;
     Entity *entity = iter->second;
-    deregisterEntity(iter);
+    removeEntity(iter);
     delete (entity);
   }
+  notifyRegistryChange();
   instance_ = 0;
   dgDEBUGOUT(15);
 }
 
+void PoolStorage::enableArena(std::size_t blockSize) {
+  if (!arena)
+    arena.reset(new Arena(blockSize));
+}
+
+Arena *PoolStorage::getArena() {
+  return (NULL != instance_) ? instance_->arena.get() : NULL;
+}
+
 /* --------------------------------------------------------------------- */
 void PoolStorage::registerEntity(const std::string &entname, Entity *ent) {
-  Entities::iterator entkey = entityMap.find(entname);
-  if (entkey != entityMap.end()) // key does exist
+  EntityIndex::iterator entkey = entityIndex.find(entname);
+  if (entkey != entityIndex.end()) // key does exist
   {
     throw ExceptionFactory(
         ExceptionFactory::OBJECT_CONFLICT,
@@ -66,7 +80,13 @@ void PoolStorage::registerEntity(const std::string &entname, Entity *ent) {
   } else {
     dgDEBUG(10) << "Register entity <" << entname << "> in the pool."
                 << std::endl;
-    entityMap[entname] = ent;
+    {
+      std::lock_guard<std::mutex> lock(entitiesMutex);
+      entityMap[entname] = ent;
+      entitiesChanged.store(true, std::memory_order_release);
+    }
+    entityIndex[entname] = ent;
+    notifyRegistryChange();
   }
 }
 
@@ -85,13 +105,40 @@ void PoolStorage::deregisterEntity(const std::string &entname) {
 }
 
 void PoolStorage::deregisterEntity(const Entities::iterator &entity) {
+  removeEntity(entity);
+  notifyRegistryChange();
+}
+
+void PoolStorage::removeEntity(const Entities::iterator &entity) {
+  // The signals of the entity cannot be evaluated anymore.
+  const Entity::SignalMap &signals = entity->second->getSignalMap();
+  for (Entity::SignalMap::const_iterator it = signals.begin();
+       it != signals.end(); ++it)
+    executionPlan.removeSink(*it->second);
+  entityIndex.erase(entity->first);
+  std::lock_guard<std::mutex> lock(entitiesMutex);
   entityMap.erase(entity);
+  entitiesChanged.store(true, std::memory_order_release);
+}
+
+PoolStorage::EntitiesSnapshot PoolStorage::getEntitySnapshot() const {
+  // The map is only copied once after a series of changes.
+  if (entitiesChanged.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(entitiesMutex);
+    if (entitiesChanged.load(std::memory_order_relaxed)) {
+      std::atomic_store(
+          &entitySnapshot,
+          EntitiesSnapshot(std::make_shared<Entities>(entityMap)));
+      entitiesChanged.store(false, std::memory_order_relaxed);
+    }
+  }
+  return std::atomic_load(&entitySnapshot);
 }
 
 Entity &PoolStorage::getEntity(const std::string &name) {
   dgDEBUG(25) << "Get <" << name << ">" << std::endl;
-  Entities::iterator entPtr = entityMap.find(name);
-  if (entPtr == entityMap.end()) {
+  EntityIndex::iterator entPtr = entityIndex.find(name);
+  if (entPtr == entityIndex.end()) {
     DG_THROW ExceptionFactory(ExceptionFactory::UNREFERED_OBJECT,
                               "Unknown entity.", " (while calling <%s>)",
                               name.c_str());
@@ -104,12 +151,12 @@ const PoolStorage::Entities &PoolStorage::getEntityMap() const {
 }
 
 bool PoolStorage::existEntity(const std::string &name) {
-  return entityMap.find(name) != entityMap.end();
+  return entityIndex.find(name) != entityIndex.end();
 }
 
 bool PoolStorage::existEntity(const std::string &name, Entity *&ptr) {
-  Entities::iterator entPtr = entityMap.find(name);
-  if (entPtr == entityMap.end())
+  EntityIndex::iterator entPtr = entityIndex.find(name);
+  if (entPtr == entityIndex.end())
     return false;
   else {
     ptr = entPtr->second;
@@ -193,6 +240,102 @@ void PoolStorage::writeGraph(const std::string &aFileName) {
   GraphFile.close();
 }
 
+namespace {
+void writeJsonString(std::ostream &os, const std::string &s) {
+  os << '"';
+  for (std::size_t i = 0; i < s.size(); ++i) {
+    const char c = s[i];
+    switch (c) {
+    case '"':
+      os << "\\\"";
+      break;
+    case '\\':
+      os << "\\\\";
+      break;
+    case '\n':
+      os << "\\n";
+      break;
+    case '\t':
+      os << "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        const char *digits = "0123456789abcdef";
+        os << "\\u00" << digits[(c >> 4) & 0xf] << digits[c & 0xf];
+      } else
+        os << c;
+    }
+  }
+  os << '"';
+}
+} // namespace
+
+void PoolStorage::writeGraphJson(std::ostream &os) {
+  os << "{\"entities\": [";
+  for (Entities::const_iterator ent = entityMap.begin(); ent != entityMap.end();
+       ++ent) {
+    const Entity::SignalMapSnapshot signals = ent->second->getSignalSnapshot();
+    double totalTime = 0.;
+    for (Entity::SignalMap::const_iterator it = signals->begin();
+         it != signals->end(); ++it)
+      totalTime += it->second->getProfile().getTotalTime();
+
+    os << (ent == entityMap.begin() ? "" : ",") << "\n {\"name\": ";
+    writeJsonString(os, ent->first);
+    os << ", \"class\": ";
+    writeJsonString(os, ent->second->getClassName());
+    os << ", \"totalTime\": " << totalTime << ", \"signals\": [";
+    for (Entity::SignalMap::const_iterator it = signals->begin();
+         it != signals->end(); ++it) {
+      const SignalBase<int> &sig = *it->second;
+      const SignalProfile &profile = sig.getProfile();
+      os << (it == signals->begin() ? "" : ",") << "\n  {\"name\": ";
+      writeJsonString(os, it->first);
+      os << ", \"id\": ";
+      writeJsonString(os, sig.getName());
+      os << ", \"time\": " << sig.getTime()
+         << ", \"calls\": " << profile.getNbCalls()
+         << ", \"recomputes\": " << profile.getNbRecomputes()
+         << ", \"cacheHits\": " << profile.getNbCacheHits()
+         << ", \"timed\": " << profile.getNbTimed()
+         << ", \"lastTime\": " << profile.getLastTime()
+         << ", \"meanTime\": " << profile.getMeanTime()
+         << ", \"maxTime\": " << profile.getMaxTime()
+         << ", \"totalTime\": " << profile.getTotalTime() << "}";
+    }
+    os << "]}";
+  }
+
+  os << "],\n\"edges\": [";
+  bool first = true;
+  std::vector<const SignalBase<int> *> deps;
+  for (Entities::const_iterator ent = entityMap.begin(); ent != entityMap.end();
+       ++ent) {
+    const Entity::SignalMapSnapshot signals = ent->second->getSignalSnapshot();
+    for (Entity::SignalMap::const_iterator it = signals->begin();
+         it != signals->end(); ++it) {
+      const SignalBase<int> &sig = *it->second;
+      deps.clear();
+      sig.collectDependencies(deps);
+      const char *type = sig.isForwarder() ? "plug" : "dependency";
+      for (std::size_t i = 0; i < deps.size(); ++i) {
+        os << (first ? "" : ",") << "\n {\"from\": ";
+        writeJsonString(os, deps[i]->getName());
+        os << ", \"to\": ";
+        writeJsonString(os, sig.getName());
+        os << ", \"type\": \"" << type << "\"}";
+        first = false;
+      }
+    }
+  }
+  os << "]}" << std::endl;
+}
+
+void PoolStorage::writeGraphJson(const std::string &aFileName) {
+  std::ofstream file(aFileName.c_str(), std::ofstream::out);
+  writeGraphJson(file);
+}
+
 void PoolStorage::writeCompletionList(std::ostream &os) {
   for (Entities::iterator iter = entityMap.begin(); iter != entityMap.end();
        ++iter) {
@@ -201,6 +344,26 @@ void PoolStorage::writeCompletionList(std::ostream &os) {
   }
 }
 
+void PoolStorage::writeProfile(std::ostream &os) {
+  for (Entities::iterator iter = entityMap.begin(); iter != entityMap.end();
+       ++iter)
+    iter->second->writeProfile(os);
+}
+
+void PoolStorage::writeProfile(const std::string &aFileName) {
+  std::ofstream file(aFileName.c_str(), std::ofstream::out);
+  writeProfile(file);
+}
+
+void PoolStorage::writeAllocationReport(std::ostream &os) {
+  AllocationDetector::report(os);
+}
+
+void PoolStorage::writeAllocationReport(const std::string &aFileName) {
+  std::ofstream file(aFileName.c_str(), std::ofstream::out);
+  writeAllocationReport(file);
+}
+
 static bool objectNameParser(std::istringstream &cmdparse, std::string &objName,
                              std::string &funName) {
   const int SIZE = 128;
@@ -228,4 +391,140 @@ SignalBase<int> &PoolStorage::getSignal(std::istringstream &sigpath) {
   return ent.getSignal(signame);
 }
 
+namespace {
+const std::string SNAPSHOT_HEADER = "dynamic-graph snapshot 1";
+const std::uint8_t SNAPSHOT_PLUGGED = 1;
+const std::uint8_t SNAPSHOT_CONSTANT = 2;
+} // namespace
+
+void PoolStorage::writeSnapshot(std::ostream &os) {
+  // Entity and name of the registered signals, to write the plugs.
+  typedef std::pair<const std::string *, const std::string *> Path;
+  std::unordered_map<const SignalBase<int> *, Path> paths;
+  std::vector<Entity::SignalMapSnapshot> signalMaps;
+  std::uint32_t nbSignals = 0;
+  for (Entities::const_iterator ent = entityMap.begin(); ent != entityMap.end();
+       ++ent) {
+    signalMaps.push_back(ent->second->getSignalSnapshot());
+    const Entity::SignalMap &signals = *signalMaps.back();
+    for (Entity::SignalMap::const_iterator sig = signals.begin();
+         sig != signals.end(); ++sig, ++nbSignals)
+      paths[sig->second] = Path(&ent->first, &sig->first);
+  }
+
+  binary::writeString(os, SNAPSHOT_HEADER);
+  binary::write<std::uint32_t>(os,
+                               static_cast<std::uint32_t>(entityMap.size()));
+  for (Entities::const_iterator ent = entityMap.begin(); ent != entityMap.end();
+       ++ent) {
+    binary::writeString(os, ent->second->getClassName());
+    binary::writeString(os, ent->first);
+  }
+
+  binary::write<std::uint32_t>(os, nbSignals);
+  std::vector<const SignalBase<int> *> plugged;
+  std::size_t e = 0;
+  for (Entities::const_iterator ent = entityMap.begin();
+       ent != entityMap.end(); ++ent, ++e) {
+    const Entity::SignalMap &signals = *signalMaps[e];
+    for (Entity::SignalMap::const_iterator it = signals.begin();
+         it != signals.end(); ++it) {
+      const SignalBase<int> &sig = *it->second;
+      // Only the plugs to registered signals can be restored.
+      plugged.clear();
+      if (sig.isForwarder())
+        sig.collectDependencies(plugged);
+      const bool isPlugged = 1 == plugged.size() && paths.count(plugged[0]);
+      const std::uint8_t flags =
+          isPlugged ? SNAPSHOT_PLUGGED
+                    : (sig.isConstant() ? SNAPSHOT_CONSTANT : 0);
+
+      binary::writeString(os, ent->first);
+      binary::writeString(os, it->first);
+      binary::write<std::int32_t>(os, sig.getPeriodTime());
+      binary::write<std::uint8_t>(os, flags);
+      if (SNAPSHOT_PLUGGED == flags) {
+        const Path &path = paths[plugged[0]];
+        binary::writeString(os, *path.first);
+        binary::writeString(os, *path.second);
+      } else if (SNAPSHOT_CONSTANT == flags) {
+        std::ostringstream value;
+        sig.writeValue(value);
+        binary::writeString(os, value.str());
+      }
+    }
+  }
+}
+
+void PoolStorage::writeSnapshot(const std::string &aFileName) {
+  std::ofstream file(aFileName.c_str(),
+                     std::ofstream::out | std::ofstream::binary);
+  writeSnapshot(file);
+}
+
+void PoolStorage::readSnapshot(std::istream &is) {
+  if (binary::readString(is) != SNAPSHOT_HEADER) {
+    DG_THROW ExceptionFactory(ExceptionFactory::SYNTAX_ERROR,
+                              "Not a snapshot of the graph.");
+  }
+
+  const std::uint32_t nbEntities = binary::read<std::uint32_t>(is);
+  for (std::uint32_t i = 0; i < nbEntities; ++i) {
+    const std::string className = binary::readString(is);
+    const std::string name = binary::readString(is);
+    Entity *entity;
+    if (!existEntity(name, entity))
+      FactoryStorage::getInstance()->newEntity(className, name);
+    else if (entity->getClassName() != className) {
+      DG_THROW ExceptionFactory(ExceptionFactory::OBJECT_CONFLICT,
+                                "Another entity already defined with the "
+                                "same name. ",
+                                "Entity name is <%s>.", name.c_str());
+    }
+  }
+
+  const std::uint32_t nbSignals = binary::read<std::uint32_t>(is);
+  for (std::uint32_t i = 0; i < nbSignals; ++i) {
+    const std::string entity = binary::readString(is);
+    SignalBase<int> &sig = getEntity(entity).getSignal(binary::readString(is));
+    const int period = binary::read<std::int32_t>(is);
+    const std::uint8_t flags = binary::read<std::uint8_t>(is);
+    if (period != sig.getPeriodTime())
+      sig.setPeriodTime(period);
+    if (SNAPSHOT_PLUGGED == flags) {
+      Entity &source = getEntity(binary::readString(is));
+      sig.plug(&source.getSignal(binary::readString(is)));
+    } else if (SNAPSHOT_CONSTANT == flags) {
+      std::istringstream value(binary::readString(is));
+      sig.readValue(value);
+    }
+  }
+}
+
+void PoolStorage::readSnapshot(const std::string &aFileName) {
+  std::ifstream file(aFileName.c_str(),
+                     std::ifstream::in | std::ifstream::binary);
+  if (!file.is_open()) {
+    DG_THROW ExceptionFactory(ExceptionFactory::GENERIC,
+                              "Cannot open the snapshot.", " (file <%s>)",
+                              aFileName.c_str());
+  }
+  readSnapshot(file);
+}
+
+SignalBase<int> &PoolStorage::getSignal(const std::string &sigpath) {
+  // Same syntax as objectNameParser.
+  static const char *const blanks = " \t\n\r";
+  const std::size_t begin = sigpath.find_first_not_of(blanks);
+  const std::size_t dot = sigpath.find('.', begin);
+  if (begin == std::string::npos || dot == std::string::npos) {
+    DG_THROW ExceptionFactory(ExceptionFactory::UNREFERED_SIGNAL,
+                              "Parse error in signal name");
+  }
+  const std::size_t end = sigpath.find_first_of(blanks, dot + 1);
+
+  Entity &ent = getEntity(sigpath.substr(begin, dot - begin));
+  return ent.getSignal(sigpath.substr(dot + 1, end - dot - 1));
+}
+
 PoolStorage *PoolStorage::instance_ = 0;
@@ -0,0 +1,40 @@
+/* Copyright 2020, LAAS-CNRS
+ *
+ * See LICENSE file in the root directory of this repository.
+ */
+
+#include <dynamic-graph/entity.h>
+#include <dynamic-graph/signal-handle.h>
+
+namespace dynamicgraph {
+
+SignalHandle::SignalHandle(const std::string &path)
+    : signal(NULL), revision(0) {
+  const std::size_t dot = path.find('.');
+  if (dot == std::string::npos) {
+    DG_THROW ExceptionFactory(ExceptionFactory::UNREFERED_SIGNAL,
+                              "Parse error in signal name", ": %s",
+                              path.c_str());
+  }
+  entityName = path.substr(0, dot);
+  signalName = path.substr(dot + 1);
+}
+
+SignalHandle::SignalHandle(const std::string &entityName,
+                           const std::string &signalName)
+    : entityName(entityName), signalName(signalName), signal(NULL),
+      revision(0) {}
+
+void SignalHandle::resolve() const {
+  signal = &PoolStorage::getInstance()->getEntity(entityName).getSignal(
+      signalName);
+  revision = PoolStorage::getRegistryRevision();
+}
+
+bool SignalHandle::isValid() const {
+  Entity *entity;
+  return PoolStorage::getInstance()->existEntity(entityName, entity) &&
+         entity->hasSignal(signalName);
+}
+
+} // namespace dynamicgraph
@@ -0,0 +1,153 @@
+/* Copyright 2020, LAAS-CNRS
+ *
+ * See LICENSE file in the root directory of this repository.
+ */
+
+#include <dynamic-graph/thread-pool.h>
+
+#include <atomic>
+#include <exception>
+
+#include <boost/bind.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace dynamicgraph {
+
+struct ThreadPool::Job {
+  boost::mutex mutex;
+  boost::condition_variable wakeUp;
+  boost::condition_variable done;
+
+  // Protected by mutex.
+  unsigned long generation;
+  std::size_t running;
+  bool shutdown;
+  std::exception_ptr error;
+
+  // Description of the current parallelFor.
+  const Task *task;
+  std::size_t size;
+  std::atomic<std::size_t> next;
+
+  Job()
+      : generation(0), running(0), shutdown(false), task(NULL), size(0),
+        next(0) {}
+};
+
+struct ThreadPool::Worker {
+  boost::thread thread;
+};
+
+ThreadPool::ThreadPool(const std::size_t &size, const bool &pinned)
+    : job(new Job) {
+  for (std::size_t i = 1; i < size; ++i) {
+    Worker *worker = new Worker;
+    worker->thread = boost::thread(&ThreadPool::spin, this, i, pinned);
+    workers.push_back(worker);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    boost::mutex::scoped_lock lock(job->mutex);
+    job->shutdown = true;
+  }
+  job->wakeUp.notify_all();
+  for (std::size_t i = 0; i < workers.size(); ++i) {
+    workers[i]->thread.join();
+    delete workers[i];
+  }
+  delete job;
+}
+
+void ThreadPool::work(Job &current) {
+  try {
+    for (std::size_t i = current.next++; i < current.size;
+         i = current.next++)
+      (*current.task)(i);
+  } catch (...) {
+    boost::mutex::scoped_lock lock(current.mutex);
+    if (!current.error)
+      current.error = std::current_exception();
+    // Make the other threads stop fetching tasks.
+    current.next = current.size;
+  }
+}
+
+void ThreadPool::spin(const std::size_t &id, const bool &pinned) {
+#ifdef __linux__
+  if (pinned) {
+    const unsigned int nbCpus = boost::thread::hardware_concurrency();
+    if (nbCpus > 0) {
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      CPU_SET(id % nbCpus, &cpus);
+      pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus);
+    }
+  }
+#else
+  (void)id;
+  (void)pinned;
+#endif
+
+  unsigned long generation = 0;
+  for (;;) {
+    {
+      boost::mutex::scoped_lock lock(job->mutex);
+      while (!job->shutdown && job->generation == generation)
+        job->wakeUp.wait(lock);
+      if (job->shutdown)
+        return;
+      generation = job->generation;
+    }
+
+    work(*job);
+
+    boost::mutex::scoped_lock lock(job->mutex);
+    if (--job->running == 0)
+      job->done.notify_one();
+  }
+}
+
+void ThreadPool::parallelFor(const std::size_t &n, const Task &task) {
+  if (n == 0)
+    return;
+  if (workers.empty() || n == 1) {
+    for (std::size_t i = 0; i < n; ++i)
+      task(i);
+    return;
+  }
+
+  {
+    boost::mutex::scoped_lock lock(job->mutex);
+    job->task = &task;
+    job->size = n;
+    job->next = 0;
+    job->error = std::exception_ptr();
+    job->running = workers.size();
+    ++job->generation;
+  }
+  job->wakeUp.notify_all();
+
+  work(*job);
+
+  std::exception_ptr error;
+  {
+    boost::mutex::scoped_lock lock(job->mutex);
+    while (job->running > 0)
+      job->done.wait(lock);
+    job->task = NULL;
+    error = job->error;
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+
+} // namespace dynamicgraph
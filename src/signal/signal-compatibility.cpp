@@ -0,0 +1,31 @@
+/* Copyright 2020, LAAS-CNRS
+ *
+ * See LICENSE file in the root directory of this repository.
+ */
+
+#include <dynamic-graph/signal-compatibility.h>
+
+namespace dynamicgraph {
+
+SignalCompatibility &SignalCompatibility::getInstance() {
+  static SignalCompatibility instance;
+  return instance;
+}
+
+void SignalCompatibility::registerConversion(const std::type_info &source,
+                                             const std::type_info &target,
+                                             Conversion conversion) {
+  std::lock_guard<std::mutex> lock(mutex);
+  conversions[Key(source, target)] = conversion;
+}
+
+SignalCompatibility::Conversion
+SignalCompatibility::getConversion(const std::type_info &source,
+                                   const std::type_info &target) const {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::map<Key, Conversion>::const_iterator it =
+      conversions.find(Key(source, target));
+  return (conversions.end() == it) ? NULL : it->second;
+}
+
+} // namespace dynamicgraph
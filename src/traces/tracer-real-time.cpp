@@ -13,12 +13,20 @@
 
 /* DG */
 #include <boost/bind.hpp>
+#include <chrono>
 #include <iomanip>
 
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif /*WIN32*/
+
 #include <dynamic-graph/all-commands.h>
 #include <dynamic-graph/debug.h>
 #include <dynamic-graph/factory.h>
 #include <dynamic-graph/pool.h>
+#include <dynamic-graph/trace-compression.h>
 #include <dynamic-graph/tracer-real-time.h>
 
 using namespace std;
@@ -26,18 +34,26 @@ using namespace dynamicgraph;
 
 DYNAMICGRAPH_FACTORY_ENTITY_PLUGIN(TracerRealTime, "TracerRealTime");
 
+const int TracerRealTime::WRITER_PERIOD_MS;
+
 /* --------------------------------------------------------------------- */
 /* --- DGOUTSTRINGSTREAM ---------------------------------------------- */
 /* --------------------------------------------------------------------- */
 
 OutStringStream::OutStringStream()
-    : std::ostringstream(), buffer(0), index(0), bufferSize(0), full(false) {
+    : std::ostringstream(), buffer(0), index(0), bufferSize(0), full(false),
+      backBuffer(0), backIndex(0), backPending(false), swapRequested(false),
+      fd(-1), mappedOffset(0), nextPart(0), retiredPart(0), mapFailed(false) {
   dgDEBUGINOUT(15);
 }
 
 OutStringStream::~OutStringStream() {
   dgDEBUGIN(15);
-  delete[] buffer;
+  if (fd >= 0)
+    unmap();
+  else
+    delete[] buffer;
+  delete[] backBuffer;
   dgDEBUGOUT(15);
 }
 
@@ -50,6 +66,12 @@ void OutStringStream::resize(const std::streamsize &size) {
 
   delete[] buffer;
   buffer = new char[static_cast<size_t>(size)];
+  if (NULL != backBuffer) {
+    delete[] backBuffer;
+    backBuffer = new char[static_cast<size_t>(size)];
+  }
+  backIndex = 0;
+  backPending = false;
 
   dgDEBUGOUT(15);
 }
@@ -57,7 +79,21 @@ void OutStringStream::resize(const std::streamsize &size) {
 bool OutStringStream::addData(const char *data, const std::streamoff &size) {
   dgDEBUGIN(15);
   std::streamsize towrite = static_cast<std::streamsize>(size);
-  if (index + towrite > bufferSize) {
+  if (fd >= 0) {
+    // Fill the mapped part of the file, then continue in the next one.
+    while (index + towrite > bufferSize) {
+      const std::streamsize part = bufferSize - index;
+      memcpy(buffer + index, data, static_cast<size_t>(part));
+      data += part;
+      towrite -= part;
+      index = bufferSize;
+      if (!mapNext()) {
+        dgDEBUGOUT(15);
+        full = true;
+        return false;
+      }
+    }
+  } else if (index + towrite > bufferSize) {
     dgDEBUGOUT(15);
     full = true;
     return false;
@@ -76,17 +112,186 @@ void OutStringStream::dump(std::ostream &os) {
 
 void OutStringStream::empty() {
   dgDEBUGIN(15);
+  // The data is already in the mapped file.
+  if (fd >= 0) {
+    dgDEBUGOUT(15);
+    return;
+  }
   index = 0;
   full = false;
   dgDEBUGOUT(15);
 }
 
+void OutStringStream::enableDoubleBuffer() {
+  if (NULL == backBuffer && fd < 0)
+    backBuffer = new char[static_cast<size_t>(bufferSize)];
+}
+
+bool OutStringStream::swap() {
+  if (NULL == backBuffer || backPending.load(std::memory_order_acquire))
+    return false;
+  std::swap(buffer, backBuffer);
+  backIndex = index;
+  index = 0;
+  full = false;
+  backPending.store(true, std::memory_order_release);
+  return true;
+}
+
+void OutStringStream::dumpBack(std::ostream &os) {
+  if (backPending.load(std::memory_order_acquire)) {
+    os.write(backBuffer, backIndex);
+    backPending.store(false, std::memory_order_release);
+  }
+}
+
+#ifndef WIN32
+namespace {
+// Allocate the disk space of a part of the file, and map it in memory.
+// Return NULL on failure.
+char *mapPart(const int &fd, const std::streamoff &offset,
+              const std::streamsize &size) {
+#ifdef __APPLE__
+  // There is no posix_fallocate: the file is only extended.
+  if (0 != ftruncate(fd, offset + size))
+    return NULL;
+#else
+  if (0 != posix_fallocate(fd, offset, size))
+    return NULL;
+#endif
+  void *ptr = mmap(NULL, static_cast<size_t>(size), PROT_READ | PROT_WRITE,
+                   MAP_SHARED, fd, offset);
+  return (MAP_FAILED == ptr) ? NULL : static_cast<char *>(ptr);
+}
+} // namespace
+#endif /*WIN32*/
+
+void OutStringStream::map(const std::string &filename,
+                          const std::streamsize &size) {
+#ifndef WIN32
+  const std::streamsize page = sysconf(_SC_PAGESIZE);
+  const std::streamsize chunk = (size + page - 1) / page * page;
+  const int desc = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (desc < 0) {
+    DG_THROW ExceptionTraces(ExceptionTraces::NOT_OPEN,
+                             "Could not open file " + filename, "");
+  }
+  char *ptr = mapPart(desc, 0, chunk);
+  if (NULL == ptr) {
+    ::close(desc);
+    DG_THROW ExceptionTraces(ExceptionTraces::NOT_OPEN,
+                             "Could not map file " + filename, "");
+  }
+  delete[] buffer;
+  buffer = ptr;
+  fd = desc;
+  mappedOffset = 0;
+  bufferSize = chunk;
+  index = 0;
+  full = false;
+  nextPart = NULL;
+  retiredPart = NULL;
+  mapFailed = false;
+  prepareNext();
+#else  /*WIN32*/
+  DG_THROW ExceptionTraces(ExceptionTraces::NOT_OPEN,
+                           "Could not map file " + filename +
+                               ": not supported on this platform",
+                           "");
+#endif /*WIN32*/
+}
+
+bool OutStringStream::mapNext() {
+#ifndef WIN32
+  // prepareNext() only holds the mutex to exchange the parts.
+  std::lock_guard<std::mutex> lock(mapMutex);
+  if (mapFailed)
+    return false;
+  if (NULL == nextPart) {
+    // The part was not mapped in advance.
+    nextPart = mapPart(fd, mappedOffset + bufferSize, bufferSize);
+    if (NULL == nextPart) {
+      mapFailed = true;
+      return false;
+    }
+  }
+  if (NULL != retiredPart)
+    munmap(retiredPart, static_cast<size_t>(bufferSize));
+  retiredPart = buffer;
+  buffer = nextPart;
+  nextPart = NULL;
+  mappedOffset += bufferSize;
+  index = 0;
+  return true;
+#else  /*WIN32*/
+  return false;
+#endif /*WIN32*/
+}
+
+void OutStringStream::prepareNext() {
+#ifndef WIN32
+  char *retired;
+  std::streamoff offset;
+  bool needed;
+  {
+    std::lock_guard<std::mutex> lock(mapMutex);
+    if (fd < 0)
+      return;
+    retired = retiredPart;
+    retiredPart = NULL;
+    offset = mappedOffset + bufferSize;
+    needed = (NULL == nextPart && !mapFailed);
+  }
+  // The system calls are done without the mutex, not to block mapNext().
+  if (NULL != retired)
+    munmap(retired, static_cast<size_t>(bufferSize));
+  if (!needed)
+    return;
+  char *part = mapPart(fd, offset, bufferSize);
+  {
+    std::lock_guard<std::mutex> lock(mapMutex);
+    // mapNext() may have mapped the part itself in the meantime.
+    if (NULL == nextPart && offset == mappedOffset + bufferSize) {
+      nextPart = part;
+      mapFailed = (NULL == part);
+      part = NULL;
+    }
+  }
+  if (NULL != part)
+    munmap(part, static_cast<size_t>(bufferSize));
+#endif /*WIN32*/
+}
+
+void OutStringStream::unmap() {
+#ifndef WIN32
+  std::lock_guard<std::mutex> lock(mapMutex);
+  if (fd < 0)
+    return;
+  munmap(buffer, static_cast<size_t>(bufferSize));
+  if (NULL != nextPart)
+    munmap(nextPart, static_cast<size_t>(bufferSize));
+  if (NULL != retiredPart)
+    munmap(retiredPart, static_cast<size_t>(bufferSize));
+  if (0 != ftruncate(fd, mappedOffset + index)) {
+    dgDEBUG(5) << "Could not truncate the mapped file." << endl;
+  }
+  ::close(fd);
+  fd = -1;
+  buffer = 0;
+  nextPart = 0;
+  retiredPart = 0;
+  bufferSize = 0;
+  index = 0;
+#endif /*WIN32*/
+}
+
 /* --------------------------------------------------------------------- */
 /* --------------------------------------------------------------------- */
 /* --------------------------------------------------------------------- */
 
 TracerRealTime::TracerRealTime(const std::string &n)
-    : Tracer(n), bufferSize(BUFFER_SIZE_DEFAULT) {
+    : Tracer(n), mappedFiles(false), bufferSize(BUFFER_SIZE_DEFAULT),
+      writerRunning(false) {
   dgDEBUGINOUT(15);
 
   /* --- Commands --- */
@@ -103,6 +308,25 @@ TracerRealTime::TracerRealTime(const std::string &n)
     addCommand("setBufferSize",
                makeDirectSetter(*this, &bufferSize,
                                 docDirectSetter("bufferSize", "int")));
+
+    addCommand("getMappedFiles",
+               makeDirectGetter(*this, &mappedFiles,
+                                docDirectGetter("mappedFiles", "bool")));
+    addCommand("setMappedFiles",
+               makeDirectSetter(*this, &mappedFiles,
+                                docDirectSetter("mappedFiles", "bool")));
+
+    doc = docCommandVoid1("Write the files in a background thread.",
+                          "bool");
+    addCommand("setAsynchronous",
+               makeCommandVoid1(*this, &TracerRealTime::setAsynchronous, doc));
+    addCommand("isAsynchronous",
+               makeCommandReturnType0(
+                   *this, &TracerRealTime::isAsynchronous,
+                   docCommandReturnType0<bool>(
+                       "Whether the files are written in a background "
+                       "thread.",
+                       "bool")));
   } // using namespace command
 
   dgDEBUGOUT(15);
@@ -115,31 +339,56 @@ TracerRealTime::TracerRealTime(const std::string &n)
 void TracerRealTime::openFile(const SignalBase<int> &sig,
                               const std::string &givenname) {
   dgDEBUGIN(15);
-  string signame;
-  if (givenname.length()) {
-    signame = givenname;
-  } else {
-    signame = sig.shortName();
+  Tracer::openFile(sig, givenname);
+  dynamic_cast<OutStringStream *>(files.back())->givenname = givenname;
+  dgDEBUGOUT(15);
+}
+
+void TracerRealTime::openStream(const std::string &filename) {
+  dgDEBUGIN(15);
+  if (mappedFiles) {
+    OutStringStream *newbuffer = new OutStringStream();
+    try {
+      newbuffer->map(filename, bufferSize);
+    } catch (...) {
+      delete newbuffer;
+      throw;
+    }
+    // The mapped files are not written by the tracer.
+    std::lock_guard<std::mutex> writer_lock(writerMutex);
+    hardFiles.push_back(NULL);
+    files.push_back(newbuffer);
+    headerWritten.push_back(false);
+    dgDEBUGOUT(15);
+    return;
   }
 
-  string filename = rootdir + basename + signame + suffix;
-  dgDEBUG(5) << "Sig <" << sig.getName() << ">: new file " << filename << endl;
-  std::ofstream *newfile = new std::ofstream(filename.c_str());
+  std::ostream *newfile;
+  if (COMPRESSED == traceFormat)
+    newfile = new CompressedTraceFile(filename, compressionPrecision);
+  else
+    newfile = new std::ofstream(filename.c_str(),
+                                (BINARY == traceFormat)
+                                    ? std::ios::out | std::ios::binary
+                                    : std::ios::out);
   if (!newfile->good()) {
     delete newfile;
-    DG_THROW ExceptionTraces(
-        ExceptionTraces::NOT_OPEN,
-        "Could not open file " + filename + " for signal " + signame, "");
+    DG_THROW ExceptionTraces(ExceptionTraces::NOT_OPEN,
+                             "Could not open file " + filename, "");
   }
   dgDEBUG(5) << "Newfile:" << (void *)newfile << endl;
-  hardFiles.push_back(newfile);
   dgDEBUG(5) << "Creating Outstringstream" << endl;
 
   // std::stringstream * newbuffer = new std::stringstream ();
   OutStringStream *newbuffer = new OutStringStream(); // std::stringstream ();
   newbuffer->resize(bufferSize);
-  newbuffer->givenname = givenname;
+  if (writerRunning.load())
+    newbuffer->enableDoubleBuffer();
+
+  std::lock_guard<std::mutex> writer_lock(writerMutex);
+  hardFiles.push_back(newfile);
   files.push_back(newbuffer);
+  headerWritten.push_back(false);
 
   dgDEBUGOUT(15);
 }
@@ -147,6 +396,7 @@ void TracerRealTime::openFile(const SignalBase<int> &sig,
 void TracerRealTime::closeFiles() {
   dgDEBUGIN(15);
   std::lock_guard<std::mutex> files_lock(files_mtx);
+  std::lock_guard<std::mutex> writer_lock(writerMutex);
 
   FileList::iterator iter = files.begin();
   HardFileList::iterator hardIter = hardFiles.begin();
@@ -154,11 +404,22 @@ void TracerRealTime::closeFiles() {
   while (files.end() != iter) {
     dgDEBUG(25) << "Close the files." << endl;
 
-    std::stringstream *file = dynamic_cast<stringstream *>(*iter);
-    std::ofstream *hardFile = *hardIter;
-
-    (*hardFile) << flush;
-    hardFile->close();
+    std::ostream *file = *iter;
+    std::ostream *hardFile = *hardIter;
+
+    // The data given to the writer is written in any case.
+    OutStringStream *buffer = dynamic_cast<OutStringStream *>(file);
+    if (NULL == hardFile) {
+      if (NULL != buffer)
+        buffer->unmap();
+    } else {
+      if (NULL != buffer) {
+        buffer->dumpBack(*hardFile);
+        if (writerRunning.load())
+          buffer->dump(*hardFile);
+      }
+      (*hardFile) << flush;
+    }
     delete file;
     delete hardFile;
 
@@ -169,6 +430,8 @@ void TracerRealTime::closeFiles() {
   dgDEBUG(25) << "Clear the lists." << endl;
   files.clear();
   hardFiles.clear();
+  headerWritten.clear();
+  recordSizes.clear();
 
   dgDEBUGOUT(15);
 }
@@ -176,6 +439,19 @@ void TracerRealTime::closeFiles() {
 void TracerRealTime::trace() {
   dgDEBUGIN(15);
 
+  if (writerRunning.load()) {
+    // The buffers are only swapped by the thread filling them.
+    std::lock_guard<std::mutex> writer_lock(writerMutex);
+    for (FileList::iterator iter = files.begin(); files.end() != iter;
+         ++iter) {
+      OutStringStream *file = dynamic_cast<OutStringStream *>(*iter);
+      if (NULL != file)
+        file->swapRequested.store(true, std::memory_order_relaxed);
+    }
+    dgDEBUGOUT(15);
+    return;
+  }
+
   FileList::iterator iter = files.begin();
   HardFileList::iterator hardIter = hardFiles.begin();
 
@@ -193,7 +469,15 @@ void TracerRealTime::trace() {
                                "The buffer is not open", "");
     }
 
-    std::ofstream &hardFile = **hardIter;
+    // The mapped files are written by the system.
+    if (NULL == *hardIter) {
+      file->prepareNext();
+      ++iter;
+      ++hardIter;
+      continue;
+    }
+
+    std::ostream &hardFile = **hardIter;
     if (!hardFile.good()) {
       DG_THROW ExceptionTraces(ExceptionTraces::NOT_OPEN,
                                "The file is not open", "");
@@ -239,7 +523,7 @@ void TracerRealTime::recordSignal(std::ostream &os,
                 << "> " << endl;
 
     Tracer::recordSignal(file, sig);
-    file.addData(file.str().c_str(), file.tellp());
+    addBufferedData(file);
     dgDEBUG(35) << "Write data [" << file.tellp() << "] <" << file.str().c_str()
                 << "> " << endl;
 
@@ -254,6 +538,112 @@ void TracerRealTime::recordSignal(std::ostream &os,
   return;
 }
 
+bool TracerRealTime::recordHeader(std::ostream &os,
+                                  const SignalBase<int> &sig) {
+  OutStringStream &file = getBuffer(os);
+  file.str("");
+  const bool written = Tracer::recordHeader(file, sig);
+  file.addData(file.str().c_str(), file.tellp());
+  return written;
+}
+
+bool TracerRealTime::recordIndex(std::ostream &os) {
+  OutStringStream &file = getBuffer(os);
+  file.str("");
+  const bool written = Tracer::recordIndex(file);
+  file.addData(file.str().c_str(), file.tellp());
+  return written;
+}
+
+void TracerRealTime::recordRow(std::ostream &os) {
+  OutStringStream &file = getBuffer(os);
+  file.str("");
+  Tracer::recordRow(file);
+  addBufferedData(file);
+}
+
+OutStringStream &TracerRealTime::getBuffer(std::ostream &os) {
+  OutStringStream *file = dynamic_cast<OutStringStream *>(&os);
+  if (NULL == file) {
+    DG_THROW ExceptionTraces(ExceptionTraces::NOT_OPEN,
+                             "The buffer is not open", "");
+  }
+  return *file;
+}
+
+void TracerRealTime::addBufferedData(OutStringStream &file) {
+  file.addData(file.str().c_str(), file.tellp());
+  if (writerRunning.load() &&
+      (2 * file.index >= file.bufferSize ||
+       file.swapRequested.load(std::memory_order_relaxed)) &&
+      file.swap()) {
+    file.swapRequested.store(false, std::memory_order_relaxed);
+    writerCondition.notify_one();
+  }
+}
+
+void TracerRealTime::setAsynchronous(const bool &async) {
+  if (async) {
+    startWriter();
+  } else {
+    // record() gives up while the last buffers are written.
+    std::lock_guard<std::mutex> files_lock(files_mtx);
+    stopWriter();
+  }
+}
+
+void TracerRealTime::startWriter() {
+  if (writer.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> writer_lock(writerMutex);
+    for (FileList::iterator iter = files.begin(); files.end() != iter;
+         ++iter) {
+      OutStringStream *file = dynamic_cast<OutStringStream *>(*iter);
+      if (NULL != file)
+        file->enableDoubleBuffer();
+    }
+  }
+  writerRunning.store(true);
+  writer = std::thread(&TracerRealTime::writerLoop, this);
+}
+
+void TracerRealTime::stopWriter() {
+  if (!writer.joinable())
+    return;
+  writerRunning.store(false);
+  writerCondition.notify_one();
+  writer.join();
+}
+
+void TracerRealTime::writerLoop() {
+  std::unique_lock<std::mutex> writer_lock(writerMutex);
+  while (writerRunning.load()) {
+    // The thread filling the buffers notifies without taking the mutex:
+    // a notification may be missed, hence the period.
+    writerCondition.wait_for(writer_lock,
+                             std::chrono::milliseconds(WRITER_PERIOD_MS));
+    dumpBackBuffers();
+  }
+  dumpBackBuffers();
+}
+
+void TracerRealTime::dumpBackBuffers() {
+  FileList::iterator iter = files.begin();
+  HardFileList::iterator hardIter = hardFiles.begin();
+  for (; files.end() != iter; ++iter, ++hardIter) {
+    OutStringStream *file = dynamic_cast<OutStringStream *>(*iter);
+    if (NULL == file)
+      continue;
+    if (NULL == *hardIter) {
+      file->prepareNext();
+    } else if (file->backPending.load(std::memory_order_acquire)) {
+      file->dumpBack(**hardIter);
+      (*hardIter)->flush();
+    }
+  }
+}
+
 /* --------------------------------------------------------------------- */
 /* --------------------------------------------------------------------- */
 /* --------------------------------------------------------------------- */
@@ -267,9 +657,12 @@ void TracerRealTime::display(std::ostream &os) const {
   for (SignalList::const_iterator iter = toTraceSignals.begin();
        toTraceSignals.end() != iter; ++iter) {
     dgDEBUG(35) << "Next" << endl;
-    const OutStringStream *file = dynamic_cast<OutStringStream *>(*iterFile);
+    // A single file is displayed with the first signal.
+    const OutStringStream *file =
+        (files.end() != iterFile) ? dynamic_cast<OutStringStream *>(*iterFile)
+                                  : NULL;
     os << "     -> " << (*iter)->getName();
-    if (file->givenname.length())
+    if (file && file->givenname.length())
       os << " (in " << file->givenname << ")";
     os << "\t";
     if (file) {
@@ -297,7 +690,8 @@ void TracerRealTime::display(std::ostream &os) const {
       os.precision(PRECISION);
     }
     os << endl;
-    ++iterFile;
+    if (files.end() != iterFile)
+      ++iterFile;
   }
 }
 
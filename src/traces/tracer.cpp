@@ -17,6 +17,7 @@
 #include <dynamic-graph/debug.h>
 #include <dynamic-graph/factory.h>
 #include <dynamic-graph/pool.h>
+#include <dynamic-graph/signal-binary-io.h>
 #include <dynamic-graph/tracer.h>
 #include <dynamic-graph/value.h>
 
@@ -26,14 +27,17 @@ using namespace dynamicgraph::command;
 
 DYNAMICGRAPH_FACTORY_ENTITY_PLUGIN(Tracer, "Tracer");
 
+const std::streamsize Tracer::VARIABLE_SIZE;
+
 /* --------------------------------------------------------------------- */
 /* --- CLASS ----------------------------------------------------------- */
 /* --------------------------------------------------------------------- */
 
 Tracer::Tracer(const std::string n)
     : Entity(n), toTraceSignals(), traceStyle(TRACE_STYLE_DEFAULT),
-      frequency(1), basename(), suffix(".dat"), rootdir(), namesSet(false),
-      files(), names(), play(false), timeStart(0),
+      frequency(1), traceFormat(TRACE_FORMAT_DEFAULT),
+      compressionPrecision(0.), singleFile(false), basename(), suffix(".dat"),
+      rootdir(), namesSet(false), files(), names(), play(false), timeStart(0),
       triger(boost::bind(&Tracer::recordTrigger, this, _1, _2), sotNOSIGNAL,
              "Tracer(" + n + ")::triger") {
   signalRegistration(triger);
@@ -66,12 +70,39 @@ Tracer::Tracer(const std::string n)
                           "(can be done automatically for some traces type).");
     addCommand("dump", makeCommandVoid0(*this, &Tracer::trace, doc));
 
+    doc = docCommandVoid1("Set the format of the files, before opening them.",
+                          "string (text, binary or compressed)");
+    addCommand("setFormat",
+               makeCommandVoid1(*this, &Tracer::setTraceFormatName, doc));
+
+    addCommand("getFormat",
+               makeCommandReturnType0(
+                   *this, &Tracer::getTraceFormatName,
+                   docCommandReturnType0<std::string>(
+                       "Get the format of the traces.", "string")));
+
+    addCommand("getCompressionPrecision",
+               makeDirectGetter(
+                   *this, &compressionPrecision,
+                   docDirectGetter("compressionPrecision", "double")));
+    addCommand("setCompressionPrecision",
+               makeDirectSetter(
+                   *this, &compressionPrecision,
+                   docDirectSetter("compressionPrecision", "double")));
+
     doc = docCommandVoid0("Start the tracing process.");
     addCommand("start", makeCommandVoid0(*this, &Tracer::start, doc));
 
     doc = docCommandVoid0("Stop temporarily the tracing process.");
     addCommand("stop", makeCommandVoid0(*this, &Tracer::stop, doc));
 
+    addCommand("getSingleFile",
+               makeDirectGetter(*this, &singleFile,
+                                docDirectGetter("singleFile", "bool")));
+    addCommand("setSingleFile",
+               makeDirectSetter(*this, &singleFile,
+                                docDirectSetter("singleFile", "bool")));
+
     addCommand("getTimeStart",
                makeDirectGetter(*this, &timeStart,
                                 docDirectGetter("timeStart", "int")));
@@ -89,8 +120,16 @@ void Tracer::addSignalToTrace(const SignalBase<int> &sig,
                               const string &filename) {
   dgDEBUGIN(15);
   // openFile may throw so it should be called first.
-  if (namesSet)
+  if (singleFile) {
+    if (!headerWritten.empty() && headerWritten.front())
+      DG_THROW ExceptionTraces(
+          ExceptionTraces::GENERIC,
+          "The columns of the trace are already written, cannot add " +
+              sig.getName(),
+          "");
+  } else if (namesSet) {
     openFile(sig, filename);
+  }
   toTraceSignals.push_back(&sig);
   dgDEBUGF(15, "%p", &sig);
   names.push_back(filename);
@@ -101,8 +140,7 @@ void Tracer::addSignalToTrace(const SignalBase<int> &sig,
 void Tracer::addSignalToTraceByName(const string &signame,
                                     const string &filename) {
   dgDEBUGIN(15);
-  istringstream iss(signame);
-  SignalBase<int> &sig = PoolStorage::getInstance()->getSignal(iss);
+  SignalBase<int> &sig = PoolStorage::getInstance()->getSignal(signame);
   addSignalToTrace(sig, filename);
   dgDEBUGOUT(15);
 }
@@ -138,6 +176,13 @@ void Tracer::openFiles(const std::string &rootdir_,
   if (files.size())
     closeFiles();
 
+  if (singleFile) {
+    openStream(rootdir + basename + suffix);
+    namesSet = true;
+    dgDEBUGOUT(15);
+    return;
+  }
+
   SignalList::const_iterator iter = toTraceSignals.begin();
   NameList::const_iterator iterName = names.begin();
   while (toTraceSignals.end() != iter) {
@@ -164,11 +209,19 @@ void Tracer::openFile(const SignalBase<int> &sig, const string &givenname) {
   string filename = rootdir + basename + signame + suffix;
 
   dgDEBUG(5) << "Sig <" << sig.getName() << ">: new file " << filename << endl;
-  std::ofstream *newfile = new std::ofstream(filename.c_str());
-  files.push_back(newfile);
+  openStream(filename);
   dgDEBUGOUT(15);
 }
 
+void Tracer::openStream(const std::string &filename) {
+  std::ofstream *newfile = new std::ofstream(
+      filename.c_str(),
+      (BINARY == traceFormat) ? std::ios::out | std::ios::binary
+                              : std::ios::out);
+  files.push_back(newfile);
+  headerWritten.push_back(false);
+}
+
 void Tracer::closeFiles() {
   dgDEBUGIN(15);
   std::lock_guard<std::mutex> files_lock(files_mtx);
@@ -178,10 +231,47 @@ void Tracer::closeFiles() {
     delete filePtr;
   }
   files.clear();
+  headerWritten.clear();
+  recordSizes.clear();
 
   dgDEBUGOUT(15);
 }
 
+void Tracer::setTraceFormat(const TraceFormat &format) {
+  if (!supportsTraceFormat(format))
+    DG_THROW ExceptionTraces(ExceptionTraces::GENERIC,
+                             "Format not supported by the tracer " + getName(),
+                             "");
+  // The records are written in the format of the open files.
+  if (format != traceFormat && !files.empty())
+    DG_THROW ExceptionTraces(ExceptionTraces::GENERIC,
+                             "Cannot change the format of the open files", "");
+  traceFormat = format;
+}
+
+void Tracer::setTraceFormatName(const std::string &format) {
+  if ("text" == format)
+    setTraceFormat(TEXT);
+  else if ("binary" == format)
+    setTraceFormat(BINARY);
+  else if ("compressed" == format)
+    setTraceFormat(COMPRESSED);
+  else
+    DG_THROW ExceptionTraces(ExceptionTraces::GENERIC,
+                             "Unknown trace format " + format, "");
+}
+
+std::string Tracer::getTraceFormatName() {
+  switch (traceFormat) {
+  case BINARY:
+    return "binary";
+  case COMPRESSED:
+    return "compressed";
+  default:
+    return "text";
+  }
+}
+
 /* --------------------------------------------------------------------- */
 /* --------------------------------------------------------------------- */
 /* --------------------------------------------------------------------- */
@@ -202,6 +292,20 @@ void Tracer::record() {
     return;
   }
 
+  if (singleFile) {
+    if (1 != files.size()) {
+      DG_THROW ExceptionTraces(ExceptionTraces::NOT_OPEN,
+                               "No file open for tracing", "");
+    }
+    // The formats of the columns are known from the first row.
+    if (!headerWritten.front())
+      headerWritten.front() = recordIndex(*files.front());
+    if (headerWritten.front())
+      recordRow(*files.front());
+    dgDEBUGOUT(15);
+    return;
+  }
+
   if (files.size() != toTraceSignals.size()) {
     DG_THROW
     ExceptionTraces(ExceptionTraces::NOT_OPEN, "No files open for tracing",
@@ -212,9 +316,17 @@ void Tracer::record() {
   FileList::iterator iterFile = files.begin();
   SignalList::iterator iterSig = toTraceSignals.begin();
 
-  while (toTraceSignals.end() != iterSig) {
+  for (std::size_t i = 0; toTraceSignals.end() != iterSig; ++i) {
     dgDEBUG(45) << "Try..." << endl;
-    recordSignal(**iterFile, **iterSig);
+    if (TEXT == traceFormat) {
+      recordSignal(**iterFile, **iterSig);
+    } else {
+      // The format of the records is known from the first value traced.
+      if (!headerWritten[i])
+        headerWritten[i] = recordHeader(**iterFile, **iterSig);
+      if (headerWritten[i])
+        recordSignal(**iterFile, **iterSig);
+    }
     ++iterSig;
     ++iterFile;
   }
@@ -225,20 +337,152 @@ void Tracer::recordSignal(std::ostream &os, const SignalBase<int> &sig) {
   dgDEBUGIN(15);
 
   try {
-    if (sig.getTime() > timeStart) {
+    if (TEXT != traceFormat) {
+      if (sig.getTime() > timeStart) {
+        recordBuffer.str("");
+        binary::write<std::int32_t>(recordBuffer, sig.getTime());
+        sig.traceBinary(recordBuffer);
+        const std::vector<std::streamsize> &sizes = recordSizes[&os];
+        if (!sizes.empty() && VARIABLE_SIZE != sizes.front() &&
+            recordBuffer.tellp() !=
+                sizes.front() + std::streamsize(sizeof(std::int32_t))) {
+          dgDEBUG(5) << "The record of <" << sig.getName()
+                     << "> changed size." << endl;
+          return;
+        }
+        os << recordBuffer.rdbuf();
+        if (EACH_TIME == traceStyle)
+          os.flush();
+      }
+    } else if (sig.getTime() > timeStart) {
       os << sig.getTime() << "\t";
       sig.trace(os);
-      os << endl;
+      // Only flush when the trace must be written immediately.
+      if (EACH_TIME == traceStyle)
+        os << endl;
+      else
+        os << '\n';
     }
   } catch (ExceptionAbstract &exc) {
-    os << exc << std::endl;
+    if (TEXT == traceFormat)
+      os << exc << std::endl;
   } catch (...) {
-    os << "Unknown error occurred while reading signal." << std::endl;
+    if (TEXT == traceFormat)
+      os << "Unknown error occurred while reading signal." << std::endl;
   }
 
   dgDEBUGOUT(15);
 }
 
+bool Tracer::recordHeader(std::ostream &os, const SignalBase<int> &sig) {
+  if (sig.getTime() <= timeStart)
+    return false;
+  try {
+    const std::string format = sig.getBinaryTraceFormat();
+    recordSizes[&os].assign(1, binaryRecordSize(sig, format));
+    binary::writeString(os, "dynamic-graph trace 1");
+    binary::writeString(os, sig.getName());
+    binary::writeString(os, format);
+  } catch (...) {
+    dgDEBUG(5) << "Signal <" << sig.getName() << "> cannot be traced." << endl;
+    return false;
+  }
+  return true;
+}
+
+bool Tracer::recordIndex(std::ostream &os) {
+  if (toTraceSignals.empty() || toTraceSignals.front()->getTime() <= timeStart)
+    return false;
+  try {
+    if (TEXT != traceFormat) {
+      std::vector<std::string> formats;
+      std::vector<std::streamsize> sizes;
+      for (SignalList::const_iterator iter = toTraceSignals.begin();
+           toTraceSignals.end() != iter; ++iter) {
+        formats.push_back((*iter)->getBinaryTraceFormat());
+        sizes.push_back(binaryRecordSize(**iter, formats.back()));
+      }
+      recordSizes[&os].swap(sizes);
+      binary::writeString(os, "dynamic-graph multiplexed trace 1");
+      binary::write<std::uint32_t>(os,
+                                   static_cast<std::uint32_t>(formats.size()));
+      std::vector<std::string>::const_iterator iterFormat = formats.begin();
+      for (SignalList::const_iterator iter = toTraceSignals.begin();
+           toTraceSignals.end() != iter; ++iter, ++iterFormat) {
+        binary::writeString(os, (*iter)->getName());
+        binary::writeString(os, *iterFormat);
+      }
+    } else {
+      os << "# time";
+      for (SignalList::const_iterator iter = toTraceSignals.begin();
+           toTraceSignals.end() != iter; ++iter)
+        os << '\t' << (*iter)->getName();
+      os << '\n';
+    }
+  } catch (...) {
+    dgDEBUG(5) << "The signals cannot be traced." << endl;
+    return false;
+  }
+  return true;
+}
+
+void Tracer::recordRow(std::ostream &os) {
+  const int time = toTraceSignals.front()->getTime();
+  if (time <= timeStart)
+    return;
+
+  // The row is only written if each column can be traced, with the size of
+  // its format in binary: a missing column would shift the next ones.
+  recordBuffer.str("");
+  if (TEXT != traceFormat)
+    binary::write<std::int32_t>(recordBuffer, time);
+  else
+    recordBuffer << time;
+  std::vector<std::streamsize>::const_iterator iterSize;
+  if (TEXT != traceFormat)
+    iterSize = recordSizes[&os].begin();
+  for (SignalList::const_iterator iter = toTraceSignals.begin();
+       toTraceSignals.end() != iter; ++iter) {
+    try {
+      if (TEXT != traceFormat) {
+        const std::streamsize expected = *iterSize++;
+        const std::streamsize start = recordBuffer.tellp();
+        (*iter)->traceBinary(recordBuffer);
+        if (VARIABLE_SIZE != expected &&
+            recordBuffer.tellp() - start != expected) {
+          dgDEBUG(5) << "The record of <" << (*iter)->getName()
+                     << "> changed size." << endl;
+          return;
+        }
+      } else {
+        recordBuffer << '\t';
+        (*iter)->trace(recordBuffer);
+      }
+    } catch (...) {
+      dgDEBUG(5) << "Signal <" << (*iter)->getName() << "> cannot be traced."
+                 << endl;
+      return;
+    }
+  }
+  if (TEXT == traceFormat)
+    recordBuffer << '\n';
+  os << recordBuffer.rdbuf();
+  // Only flush when the trace must be written immediately.
+  if (EACH_TIME == traceStyle)
+    os.flush();
+}
+
+std::streamsize Tracer::binaryRecordSize(const SignalBase<int> &sig,
+                                         const std::string &format) {
+  // Only the records of the text form have a variable size (see
+  // signal_binary_io).
+  if ("text" == format)
+    return VARIABLE_SIZE;
+  recordBuffer.str("");
+  sig.traceBinary(recordBuffer);
+  return recordBuffer.tellp();
+}
+
 int &Tracer::recordTrigger(int &dummy, const int &time) {
   dgDEBUGIN(15) << "    time=" << time << endl;
   record();
@@ -246,7 +490,11 @@ int &Tracer::recordTrigger(int &dummy, const int &time) {
   return dummy;
 }
 
-void Tracer::trace() {}
+void Tracer::trace() {
+  std::lock_guard<std::mutex> files_lock(files_mtx);
+  for (FileList::iterator iter = files.begin(); files.end() != iter; ++iter)
+    (*iter)->flush();
+}
 
 /* --------------------------------------------------------------------- */
 /* --------------------------------------------------------------------- */
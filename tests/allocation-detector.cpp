@@ -0,0 +1,66 @@
+// Copyright 2020, LAAS-CNRS
+//
+
+#include <sstream>
+
+#include <dynamic-graph/allocation-detector.h>
+#include <dynamic-graph/linear-algebra.h>
+#include <dynamic-graph/pool.h>
+#include <dynamic-graph/signal.h>
+
+#define BOOST_TEST_MODULE allocation_detector
+
+#include <boost/test/unit_test.hpp>
+
+typedef dynamicgraph::Signal<dynamicgraph::Vector, int> sigVector_t;
+
+namespace dg = dynamicgraph;
+
+dg::Vector &growing(dg::Vector &res, int t) {
+  res.resize(t);
+  res.setZero();
+  return res;
+}
+
+dg::Vector &constantSize(dg::Vector &res, int) {
+  res.setOnes();
+  return res;
+}
+
+BOOST_AUTO_TEST_CASE(detect) {
+  BOOST_REQUIRE(dg::AllocationDetector::hasHooks());
+  sigVector_t allocating("Test(ent)::output(vector)::allocating");
+  allocating.setFunction(&growing);
+  sigVector_t realTime("Test(ent)::output(vector)::realTime");
+  realTime.setConstant(dg::Vector::Zero(10));
+  realTime.setFunction(&constantSize);
+
+  // Disabled by default.
+  allocating(1);
+  BOOST_CHECK_EQUAL(dg::AllocationDetector::getNbAllocations(), 0);
+
+  dg::AllocationDetector::enable();
+  // Allocations outside the evaluation of signals are not recorded.
+  dg::Vector *outside = new dg::Vector(100);
+  delete outside;
+  BOOST_CHECK_EQUAL(dg::AllocationDetector::getNbAllocations(), 0);
+
+  for (int t = 2; t < 5; ++t) {
+    allocating(t);
+    realTime(t);
+  }
+  dg::AllocationDetector::enable(false);
+  BOOST_CHECK_EQUAL(dg::AllocationDetector::getNbAllocations(), 3);
+
+  std::ostringstream report;
+  dg::PoolStorage::getInstance()->writeAllocationReport(report);
+  const std::string res = report.str();
+  BOOST_CHECK(res.find("3 allocations during") == 0);
+  BOOST_CHECK(res.find("Entity ent") != std::string::npos);
+  BOOST_CHECK(res.find("::allocating: 3 allocations") != std::string::npos);
+  BOOST_CHECK(res.find("realTime") == std::string::npos);
+
+  dg::AllocationDetector::clear();
+  BOOST_CHECK_EQUAL(dg::AllocationDetector::getNbAllocations(), 0);
+  dg::PoolStorage::destroy();
+}
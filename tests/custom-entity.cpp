@@ -5,6 +5,7 @@
 #include <dynamic-graph/exception-factory.h>
 #include <dynamic-graph/factory.h>
 #include <dynamic-graph/pool.h>
+#include <dynamic-graph/signal-helper.h>
 #include <sstream>
 
 #define BOOST_TEST_MODULE customEntity
@@ -32,6 +33,30 @@ struct CustomEntity : public dynamicgraph::Entity {
 
 DYNAMICGRAPH_FACTORY_ENTITY_PLUGIN(CustomEntity, "CustomEntity");
 
+struct HelperEntity : public dynamicgraph::Entity {
+  static const std::string CLASS_NAME;
+
+  virtual const std::string &getClassName() const { return CLASS_NAME; }
+
+#define EntityClassName HelperEntity
+  explicit HelperEntity(const std::string &n)
+      : Entity(n), CONSTRUCT_SIGNAL_IN(in, double),
+        CONSTRUCT_SIGNAL_OUT(out, double, m_inSIN) {
+    signalRegistration(m_inSIN << m_outSOUT);
+  }
+#undef EntityClassName
+
+  DECLARE_SIGNAL_IN(in, double);
+  DECLARE_SIGNAL_OUT(out, double);
+};
+
+double &HelperEntity::outSOUT_function(double &res, int t) {
+  res = m_inSIN(t) + t;
+  return res;
+}
+
+DYNAMICGRAPH_FACTORY_ENTITY_PLUGIN(HelperEntity, "HelperEntity");
+
 BOOST_AUTO_TEST_CASE(constructor) {
   BOOST_CHECK_EQUAL(CustomEntity::CLASS_NAME, "CustomEntity");
 
@@ -59,3 +84,11 @@ BOOST_AUTO_TEST_CASE(display) {
   // Deregister entities before destroying them
   dynamicgraph::PoolStorage::destroy();
 }
+
+BOOST_AUTO_TEST_CASE(signal_helper) {
+  HelperEntity entity("helper");
+  entity.m_inSIN = 2.;
+  BOOST_CHECK_EQUAL(entity.m_outSOUT(3), 5.);
+  BOOST_CHECK_EQUAL(entity.getSignal("out").getName(),
+                    "HelperEntity(helper)::output(double)::out");
+}
@@ -4,15 +4,21 @@
  *
  */
 
+#include <chrono>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <thread>
 
 #include <dynamic-graph/command.h>
 #include <dynamic-graph/entity.h>
 #include <dynamic-graph/exception-factory.h>
 #include <dynamic-graph/factory.h>
 #include <dynamic-graph/pool.h>
+#include <dynamic-graph/signal-binary-io.h>
 #include <dynamic-graph/signal-ptr.h>
 #include <dynamic-graph/signal-time-dependent.h>
+#include <dynamic-graph/trace-compression.h>
 #include <dynamic-graph/tracer-real-time.h>
 #define BOOST_TEST_MODULE debug - tracer
 
@@ -118,3 +124,265 @@ BOOST_AUTO_TEST_CASE(test_tracer) {
       "     -> MyEntity(my-entity)::input(double)::out_double (in output)"
       "	[8Ko/16Ko]	\n"));
 }
+
+BOOST_AUTO_TEST_CASE(test_tracer_binary) {
+  using namespace dynamicgraph;
+
+  TracerRealTime &atracer = *dynamic_cast<TracerRealTime *>(
+      FactoryStorage::getInstance()->newEntity("TracerRealTime",
+                                               "my-binary-tracer"));
+  MyEntity &entity = *dynamic_cast<MyEntity *>(
+      FactoryStorage::getInstance()->newEntity("MyEntity", "my-binary-entity"));
+
+  atracer.setTraceFormat(Tracer::BINARY);
+  atracer.openFiles("/tmp", "my-binary-tracer", ".bin");
+  atracer.addSignalToTraceByName("my-binary-entity.out_double", "output");
+  entity.m_sigdSIN.setConstant(2.5);
+
+  atracer.start();
+  for (int i = 1; i <= 100; i++) {
+    entity.m_sigdTimeDepSOUT.recompute(i);
+    entity.m_sigdTimeDepSOUT.setTime(i);
+    atracer.recordTrigger(i, i);
+  }
+  atracer.stop();
+  atracer.trace();
+  atracer.closeFiles();
+
+  std::ifstream output("/tmp/my-binary-traceroutput.bin", std::ios::binary);
+  BOOST_CHECK_EQUAL(binary::readString(output), "dynamic-graph trace 1");
+  BOOST_CHECK_EQUAL(binary::readString(output),
+                    "MyEntity(my-binary-entity)::input(double)::out_double");
+  BOOST_CHECK_EQUAL(binary::readString(output), "float64");
+  for (int i = 1; i <= 100; i++) {
+    BOOST_CHECK_EQUAL(binary::read<std::int32_t>(output), i);
+    BOOST_CHECK_EQUAL(binary::read<double>(output), 2.5);
+  }
+  BOOST_CHECK_EQUAL(output.peek(), std::char_traits<char>::eof());
+}
+
+BOOST_AUTO_TEST_CASE(test_tracer_asynchronous) {
+  using namespace dynamicgraph;
+
+  TracerRealTime &atracer = *dynamic_cast<TracerRealTime *>(
+      FactoryStorage::getInstance()->newEntity("TracerRealTime",
+                                               "my-async-tracer"));
+  MyEntity &entity = *dynamic_cast<MyEntity *>(
+      FactoryStorage::getInstance()->newEntity("MyEntity", "my-async-entity"));
+
+  // The buffer is swapped every 22 records.
+  atracer.setBufferSize(512);
+  atracer.setTraceFormat(Tracer::BINARY);
+  atracer.openFiles("/tmp", "my-async-tracer", ".bin");
+  atracer.addSignalToTraceByName("my-async-entity.out_double", "output");
+  BOOST_CHECK(!atracer.isAsynchronous());
+  atracer.setAsynchronous(true);
+  BOOST_CHECK(atracer.isAsynchronous());
+  entity.m_sigdSIN.setConstant(0.5);
+
+  atracer.start();
+  for (int i = 1; i <= 200; i++) {
+    entity.m_sigdTimeDepSOUT.recompute(i);
+    entity.m_sigdTimeDepSOUT.setTime(i);
+    atracer.recordTrigger(i, i);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  atracer.stop();
+  // Everything is written when the files are closed.
+  atracer.closeFiles();
+  atracer.setAsynchronous(false);
+  BOOST_CHECK(!atracer.isAsynchronous());
+
+  std::ifstream output("/tmp/my-async-traceroutput.bin", std::ios::binary);
+  BOOST_CHECK_EQUAL(binary::readString(output), "dynamic-graph trace 1");
+  BOOST_CHECK_EQUAL(binary::readString(output),
+                    "MyEntity(my-async-entity)::input(double)::out_double");
+  BOOST_CHECK_EQUAL(binary::readString(output), "float64");
+  for (int i = 1; i <= 200; i++) {
+    BOOST_CHECK_EQUAL(binary::read<std::int32_t>(output), i);
+    BOOST_CHECK_EQUAL(binary::read<double>(output), 0.5);
+  }
+  BOOST_CHECK_EQUAL(output.peek(), std::char_traits<char>::eof());
+}
+
+BOOST_AUTO_TEST_CASE(test_tracer_compressed) {
+  using namespace dynamicgraph;
+
+  // The same trace, compressed and not.
+  TracerRealTime &compressed = *dynamic_cast<TracerRealTime *>(
+      FactoryStorage::getInstance()->newEntity("TracerRealTime",
+                                               "my-compressed-tracer"));
+  TracerRealTime &reference = *dynamic_cast<TracerRealTime *>(
+      FactoryStorage::getInstance()->newEntity("TracerRealTime",
+                                               "my-reference-tracer"));
+  MyEntity &entity = *dynamic_cast<MyEntity *>(
+      FactoryStorage::getInstance()->newEntity("MyEntity",
+                                               "my-compressed-entity"));
+
+  compressed.setTraceFormatName("compressed");
+  BOOST_CHECK_EQUAL(compressed.getTraceFormatName(), "compressed");
+  reference.setTraceFormat(Tracer::BINARY);
+  TracerRealTime *tracers[] = {&compressed, &reference};
+  for (int t = 0; t < 2; ++t) {
+    tracers[t]->singleFile = true;
+    tracers[t]->openFiles("/tmp", tracers[t]->getName(), ".bin");
+    tracers[t]->addSignalToTraceByName("my-compressed-entity.out_double");
+    tracers[t]->addSignalToTraceByName("my-compressed-entity.out2double");
+    tracers[t]->start();
+  }
+
+  for (int i = 1; i <= 1000; i++) {
+    entity.m_sigdSIN.setConstant((i < 500) ? 1.5 : 0.25 * i);
+    entity.m_sigdTimeDepSOUT.recompute(i);
+    entity.m_sigdTimeDepSOUT.setTime(i);
+    entity.m_sigdTwoTimeDepSOUT.recompute(i);
+    entity.m_sigdTwoTimeDepSOUT.setTime(i);
+    compressed.recordTrigger(i, i);
+    reference.recordTrigger(i, i);
+  }
+  for (int t = 0; t < 2; ++t) {
+    tracers[t]->stop();
+    tracers[t]->trace();
+    tracers[t]->closeFiles();
+  }
+
+  std::ifstream referenceFile("/tmp/my-reference-tracer.bin",
+                              std::ios::binary);
+  std::ostringstream expected;
+  expected << referenceFile.rdbuf();
+  std::ifstream compressedFile("/tmp/my-compressed-tracer.bin",
+                               std::ios::binary);
+  std::ostringstream data;
+  data << compressedFile.rdbuf();
+  BOOST_CHECK_LT(4 * data.str().size(), expected.str().size());
+
+  std::istringstream is(data.str());
+  std::ostringstream os;
+  BOOST_CHECK_EQUAL(decompressTrace(is, os), 1000);
+  BOOST_CHECK(os.str() == expected.str());
+
+  // Only the complete records of truncated data are written.
+  std::istringstream truncated(data.str().substr(0, data.str().size() / 2));
+  std::ostringstream partial;
+  const std::size_t nbRecords = decompressTrace(truncated, partial);
+  BOOST_CHECK_GT(nbRecords, 0);
+  BOOST_CHECK_LT(nbRecords, 1000);
+  BOOST_CHECK_EQUAL(nbRecords * (4 + 2 * 8),
+                    partial.str().size() -
+                        (expected.str().size() - 1000 * (4 + 2 * 8)));
+  BOOST_CHECK(partial.str() == expected.str().substr(0, partial.str().size()));
+
+  // The data which is not compressed is copied.
+  std::istringstream binaryIs(expected.str());
+  std::ostringstream binaryOs;
+  BOOST_CHECK_EQUAL(decompressTrace(binaryIs, binaryOs), 0);
+  BOOST_CHECK(binaryOs.str() == expected.str());
+}
+
+BOOST_AUTO_TEST_CASE(test_tracer_single_file) {
+  using namespace dynamicgraph;
+
+  TracerRealTime &atracer = *dynamic_cast<TracerRealTime *>(
+      FactoryStorage::getInstance()->newEntity("TracerRealTime",
+                                               "my-single-tracer"));
+  MyEntity &entity = *dynamic_cast<MyEntity *>(
+      FactoryStorage::getInstance()->newEntity("MyEntity", "my-single-entity"));
+
+  atracer.setTraceFormat(Tracer::BINARY);
+  atracer.singleFile = true;
+  atracer.addSignalToTraceByName("my-single-entity.out_double");
+  atracer.addSignalToTraceByName("my-single-entity.in_double");
+  atracer.openFiles("/tmp", "my-single-tracer", ".bin");
+  entity.m_sigdSIN.setConstant(3.5);
+
+  output_test_stream display;
+  atracer.display(display);
+  BOOST_CHECK(display.is_equal(
+      "TracerRealTime my-single-tracer [mode=pause] : \n"
+      "  - Dep list: \n"
+      "     -> MyEntity(my-single-entity)::input(double)::out_double"
+      "\t[0Mo/1Mo]\t\n"
+      "     -> MyEntity(my-single-entity)::input(double)::in_double\t\n"));
+
+  atracer.start();
+  for (int i = 1; i <= 10; i++) {
+    entity.m_sigdTimeDepSOUT.recompute(i);
+    entity.m_sigdTimeDepSOUT.setTime(i);
+    atracer.recordTrigger(i, i);
+  }
+  atracer.stop();
+  atracer.trace();
+  atracer.closeFiles();
+
+  std::ifstream output("/tmp/my-single-tracer.bin", std::ios::binary);
+  BOOST_CHECK_EQUAL(binary::readString(output),
+                    "dynamic-graph multiplexed trace 1");
+  BOOST_CHECK_EQUAL(binary::read<std::uint32_t>(output), 2);
+  BOOST_CHECK_EQUAL(binary::readString(output),
+                    "MyEntity(my-single-entity)::input(double)::out_double");
+  BOOST_CHECK_EQUAL(binary::readString(output), "float64");
+  BOOST_CHECK_EQUAL(binary::readString(output),
+                    "MyEntity(my-single-entity)::input(double)::in_double");
+  BOOST_CHECK_EQUAL(binary::readString(output), "float64");
+  for (int i = 1; i <= 10; i++) {
+    BOOST_CHECK_EQUAL(binary::read<std::int32_t>(output), i);
+    BOOST_CHECK_EQUAL(binary::read<double>(output), 3.5);
+    BOOST_CHECK_EQUAL(binary::read<double>(output), 3.5);
+  }
+  BOOST_CHECK_EQUAL(output.peek(), std::char_traits<char>::eof());
+}
+
+BOOST_AUTO_TEST_CASE(test_tracer_mapped_files) {
+  using namespace dynamicgraph;
+
+  TracerRealTime &atracer = *dynamic_cast<TracerRealTime *>(
+      FactoryStorage::getInstance()->newEntity("TracerRealTime",
+                                               "my-mapped-tracer"));
+  MyEntity &entity = *dynamic_cast<MyEntity *>(
+      FactoryStorage::getInstance()->newEntity("MyEntity", "my-mapped-entity"));
+
+  // The parts of the file have the size of a page: the records are written
+  // over several parts.
+  atracer.setBufferSize(1);
+  atracer.setTraceFormat(Tracer::BINARY);
+  atracer.mappedFiles = true;
+  atracer.openFiles("/tmp", "my-mapped-tracer", ".bin");
+  atracer.addSignalToTraceByName("my-mapped-entity.out_double", "output");
+  entity.m_sigdSIN.setConstant(4.5);
+  // The second part is mapped in advance.
+  OutStringStream &file =
+      dynamic_cast<OutStringStream &>(*atracer.files.front());
+  BOOST_CHECK(file.nextPart != NULL);
+
+  const int nbRecords = 1000;
+  atracer.start();
+  for (int i = 1; i <= nbRecords; i++) {
+    entity.m_sigdTimeDepSOUT.recompute(i);
+    entity.m_sigdTimeDepSOUT.setTime(i);
+    atracer.recordTrigger(i, i);
+  }
+  atracer.stop();
+
+  // The data is in the file without being dumped.
+  {
+    std::ifstream output("/tmp/my-mapped-traceroutput.bin", std::ios::binary);
+    BOOST_CHECK_EQUAL(binary::readString(output), "dynamic-graph trace 1");
+  }
+  // trace() maps the next part and unmaps the previous one.
+  atracer.trace();
+  BOOST_CHECK(file.nextPart != NULL);
+  BOOST_CHECK(file.retiredPart == NULL);
+  atracer.closeFiles();
+
+  std::ifstream output("/tmp/my-mapped-traceroutput.bin", std::ios::binary);
+  BOOST_CHECK_EQUAL(binary::readString(output), "dynamic-graph trace 1");
+  BOOST_CHECK_EQUAL(binary::readString(output),
+                    "MyEntity(my-mapped-entity)::input(double)::out_double");
+  BOOST_CHECK_EQUAL(binary::readString(output), "float64");
+  for (int i = 1; i <= nbRecords; i++) {
+    BOOST_CHECK_EQUAL(binary::read<std::int32_t>(output), i);
+    BOOST_CHECK_EQUAL(binary::read<double>(output), 4.5);
+  }
+  // The file is truncated to the data.
+  BOOST_CHECK_EQUAL(output.peek(), std::char_traits<char>::eof());
+}
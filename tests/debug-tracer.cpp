@@ -4,14 +4,21 @@
  *
  */
 
+#include <algorithm>
+#include <cmath>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <vector>
 
 #include <dynamic-graph/entity.h>
 #include <dynamic-graph/exception-factory.h>
 #include <dynamic-graph/factory.h>
 #include <dynamic-graph/pool.h>
+#include <dynamic-graph/signal-binary-io.h>
 #include <dynamic-graph/signal-ptr.h>
 #include <dynamic-graph/signal-time-dependent.h>
+#include <dynamic-graph/trace-compression.h>
 #include <dynamic-graph/tracer.h>
 
 #define BOOST_TEST_MODULE debug - tracer
@@ -31,6 +38,7 @@ struct MyEntity : public dynamicgraph::Entity {
   dynamicgraph::SignalTimeDependent<double, int> m_sigdTimeDepSOUT;
   dynamicgraph::SignalTimeDependent<Vector, int> m_sigVTimeDepSOUT;
   dynamicgraph::SignalTimeDependent<double, int> m_sigdTwoTimeDepSOUT;
+  int vectorSize;
 
   explicit MyEntity(const std::string &name)
       : Entity(name),
@@ -43,7 +51,8 @@ struct MyEntity : public dynamicgraph::Entity {
                           "MyEntity(" + name + ")::input(vector)::out_vector"),
         m_sigdTwoTimeDepSOUT(
             boost::bind(&MyEntity::update, this, _1, _2), m_sigdSIN,
-            "MyEntity(" + name + ")::input(double)::out2double")
+            "MyEntity(" + name + ")::input(double)::out2double"),
+        vectorSize(2)
 
   {
     signalRegistration(m_sigdSIN << m_sigdTimeDepSOUT << m_sigVTimeDepSOUT
@@ -64,8 +73,8 @@ struct MyEntity : public dynamicgraph::Entity {
 
   Vector &updateVector(Vector &res, const int &inTime) {
     const double &aDouble = m_sigdSIN(inTime);
-    res.resize(2);
-    res << aDouble, 2 * aDouble;
+    res.setConstant(vectorSize, 2 * aDouble);
+    res(0) = aDouble;
     return res;
   }
 };
@@ -128,3 +137,196 @@ BOOST_AUTO_TEST_CASE(test_tracer) {
 
   atracer.record();
 }
+
+BOOST_AUTO_TEST_CASE(test_tracer_binary) {
+  using namespace dynamicgraph;
+
+  Tracer &atracer = *dynamic_cast<Tracer *>(
+      FactoryStorage::getInstance()->newEntity("Tracer", "my-binary-tracer"));
+  MyEntity &entity = *dynamic_cast<MyEntity *>(
+      FactoryStorage::getInstance()->newEntity("MyEntity", "my-binary-entity"));
+
+  BOOST_CHECK_EQUAL(atracer.getTraceFormatName(), "text");
+  BOOST_CHECK_THROW(atracer.setTraceFormatName("unknown"), ExceptionTraces);
+  atracer.setTraceFormatName("binary");
+  BOOST_CHECK_EQUAL(atracer.getTraceFormat(), Tracer::BINARY);
+
+  atracer.openFiles("/tmp", "my-binary-tracer", ".bin");
+  atracer.addSignalToTraceByName("my-binary-entity.out_double", "output");
+  atracer.addSignalToTraceByName("my-binary-entity.out_vector", "vector");
+  entity.m_sigdSIN.setConstant(1.5);
+
+  // The format cannot change while the files are open.
+  BOOST_CHECK_THROW(atracer.setTraceFormat(Tracer::TEXT), ExceptionTraces);
+  atracer.setTraceFormat(Tracer::BINARY);
+
+  atracer.start();
+  for (int i = 1; i <= 10; i++) {
+    // The record of a vector which changed size is not written.
+    entity.vectorSize = (5 == i) ? 3 : 2;
+    entity.m_sigVTimeDepSOUT.setReady();
+    entity.m_sigdTimeDepSOUT.recompute(i);
+    entity.m_sigdTimeDepSOUT.setTime(i);
+    entity.m_sigVTimeDepSOUT.recompute(i);
+    entity.m_sigVTimeDepSOUT.setTime(i);
+    atracer.recordTrigger(i, i);
+  }
+  atracer.stop();
+  atracer.closeFiles();
+
+  std::ifstream output("/tmp/my-binary-traceroutput.bin", std::ios::binary);
+  BOOST_CHECK_EQUAL(binary::readString(output), "dynamic-graph trace 1");
+  BOOST_CHECK_EQUAL(binary::readString(output),
+                    "MyEntity(my-binary-entity)::input(double)::out_double");
+  BOOST_CHECK_EQUAL(binary::readString(output), "float64");
+  for (int i = 1; i <= 10; i++) {
+    BOOST_CHECK_EQUAL(binary::read<std::int32_t>(output), i);
+    BOOST_CHECK_EQUAL(binary::read<double>(output), 1.5);
+  }
+  BOOST_CHECK_EQUAL(output.peek(), std::char_traits<char>::eof());
+
+  std::ifstream vector("/tmp/my-binary-tracervector.bin", std::ios::binary);
+  binary::readString(vector);
+  binary::readString(vector);
+  BOOST_CHECK_EQUAL(binary::readString(vector), "float64[2x1]");
+  for (int i = 1; i <= 10; i++) {
+    if (5 == i)
+      continue;
+    BOOST_CHECK_EQUAL(binary::read<std::int32_t>(vector), i);
+    BOOST_CHECK_EQUAL(binary::read<double>(vector), 1.5);
+    BOOST_CHECK_EQUAL(binary::read<double>(vector), 3.);
+  }
+  BOOST_CHECK_EQUAL(vector.peek(), std::char_traits<char>::eof());
+}
+
+BOOST_AUTO_TEST_CASE(test_tracer_single_file) {
+  using namespace dynamicgraph;
+
+  Tracer &atracer = *dynamic_cast<Tracer *>(
+      FactoryStorage::getInstance()->newEntity("Tracer", "my-single-tracer"));
+  MyEntity &entity = *dynamic_cast<MyEntity *>(
+      FactoryStorage::getInstance()->newEntity("MyEntity", "my-single-entity"));
+
+  atracer.singleFile = true;
+  atracer.openFiles("/tmp", "my-single-tracer", ".dat");
+  atracer.addSignalToTraceByName("my-single-entity.out_double");
+  atracer.addSignalToTraceByName("my-single-entity.out2double");
+  // A signal which cannot be traced when it is unplugged.
+  SignalPtr<double, int> plugged(NULL, "plugged");
+  plugged.plug(&entity.m_sigdSIN);
+  atracer.addSignalToTrace(plugged);
+  BOOST_CHECK_EQUAL(atracer.files.size(), 1);
+  entity.m_sigdSIN.setConstant(1.5);
+
+  atracer.start();
+  for (int i = 1; i <= 3; i++) {
+    // The row of a signal which throws is skipped as a whole.
+    if (2 == i)
+      plugged.unplug();
+    else
+      plugged.plug(&entity.m_sigdSIN);
+    entity.m_sigdTimeDepSOUT.recompute(i);
+    entity.m_sigdTimeDepSOUT.setTime(i);
+    entity.m_sigdTwoTimeDepSOUT.recompute(i);
+    entity.m_sigdTwoTimeDepSOUT.setTime(i);
+    atracer.recordTrigger(i, i);
+  }
+  // The columns cannot change once written.
+  BOOST_CHECK_THROW(
+      atracer.addSignalToTraceByName("my-single-entity.in_double"),
+      ExceptionTraces);
+  atracer.stop();
+  atracer.closeFiles();
+  atracer.clearSignalToTrace();
+
+  std::ifstream output("/tmp/my-single-tracer.dat");
+  std::string line;
+  std::getline(output, line);
+  BOOST_CHECK_EQUAL(line, "# time"
+                          "\tMyEntity(my-single-entity)::input(double)::"
+                          "out_double"
+                          "\tMyEntity(my-single-entity)::input(double)::"
+                          "out2double"
+                          "\tplugged");
+  for (int i = 1; i <= 3; i += 2) {
+    std::getline(output, line);
+    std::ostringstream expected;
+    expected << i << "\t1.5\t1.5\t1.5";
+    BOOST_CHECK_EQUAL(line, expected.str());
+  }
+  BOOST_CHECK(!std::getline(output, line));
+}
+
+BOOST_AUTO_TEST_CASE(test_tracer_compressed) {
+  using namespace dynamicgraph;
+
+  // Only the TracerRealTime compresses its traces, out of record().
+  Tracer &tracer = *dynamic_cast<Tracer *>(
+      FactoryStorage::getInstance()->newEntity("Tracer",
+                                               "my-compressed-tracer"));
+  BOOST_CHECK_THROW(tracer.setTraceFormatName("compressed"), ExceptionTraces);
+  BOOST_CHECK_THROW(tracer.setTraceFormat(Tracer::COMPRESSED),
+                    ExceptionTraces);
+  BOOST_CHECK_EQUAL(tracer.getTraceFormatName(), "text");
+}
+
+BOOST_AUTO_TEST_CASE(test_tracer_compressed_joints) {
+  using namespace dynamicgraph;
+
+  // The positions of 6 joints, slow sinusoids sampled at 1 kHz.
+  const int nbRecords = 10000;
+  const double pi = 3.14159265358979323846;
+  std::ostringstream trace;
+  binary::writeString(trace, "dynamic-graph trace 1");
+  binary::writeString(trace, "robot::position");
+  binary::writeString(trace, "float64[6x1]");
+  std::vector<double> positions;
+  for (int i = 1; i <= nbRecords; ++i) {
+    binary::write<std::int32_t>(trace, i);
+    for (int j = 0; j < 6; ++j) {
+      positions.push_back((0.5 + 0.1 * j) *
+                          std::sin(2 * pi * 0.2 * 1e-3 * i + j));
+      binary::write(trace, positions.back());
+    }
+  }
+  const std::string data = trace.str();
+
+  // Kept exactly, the last bits of the positions change at each record.
+  std::ostringstream exact;
+  TraceCompressor exactCompressor(exact);
+  exactCompressor.write(data.data(), static_cast<std::streamsize>(data.size()));
+  exactCompressor.finish();
+  std::istringstream exactIs(exact.str());
+  std::ostringstream exactOs;
+  BOOST_CHECK_EQUAL(decompressTrace(exactIs, exactOs), nbRecords);
+  BOOST_CHECK(exactOs.str() == data);
+
+  // Rounded to a micro-radian.
+  const double precision = 1e-6;
+  std::ostringstream quantized;
+  TraceCompressor compressor(quantized, precision);
+  compressor.write(data.data(), static_cast<std::streamsize>(data.size()));
+  compressor.finish();
+  BOOST_TEST_MESSAGE("Ratio: " << double(data.size()) / exact.str().size()
+                               << " exact, "
+                               << double(data.size()) / quantized.str().size()
+                               << " rounded.");
+  BOOST_CHECK_LT(10 * quantized.str().size(), data.size());
+
+  std::istringstream is(quantized.str());
+  std::ostringstream os;
+  BOOST_CHECK_EQUAL(decompressTrace(is, os), nbRecords);
+  std::istringstream decompressed(os.str());
+  BOOST_CHECK_EQUAL(binary::readString(decompressed), "dynamic-graph trace 1");
+  BOOST_CHECK_EQUAL(binary::readString(decompressed), "robot::position");
+  BOOST_CHECK_EQUAL(binary::readString(decompressed), "float64[6x1]");
+  double maxError = 0;
+  for (int i = 1; i <= nbRecords; ++i) {
+    BOOST_CHECK_EQUAL(binary::read<std::int32_t>(decompressed), i);
+    for (int j = 0; j < 6; ++j)
+      maxError = std::max(maxError,
+                          std::fabs(binary::read<double>(decompressed) -
+                                    positions[6 * (i - 1) + j]));
+  }
+  BOOST_CHECK_LE(maxError, 0.51 * precision);
+}
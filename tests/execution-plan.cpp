@@ -0,0 +1,294 @@
+// Copyright 2020, LAAS-CNRS
+//
+
+#include <iostream>
+
+#include <dynamic-graph/execution-plan.h>
+#include <dynamic-graph/signal-ptr.h>
+#include <dynamic-graph/signal-time-dependent.h>
+
+#define BOOST_TEST_MODULE execution_plan
+
+#include <boost/test/unit_test.hpp>
+
+typedef dynamicgraph::SignalTimeDependent<double, int> sigDouble_t;
+typedef dynamicgraph::SignalPtr<double, int> sigPtr_t;
+
+namespace dg = dynamicgraph;
+
+// Diamond shaped graph:  in --> a --> out
+//                           `-> b --'
+class Diamond {
+public:
+  sigPtr_t in;
+  sigDouble_t a, b, out;
+  int callsA, callsB, callsOut;
+
+  Diamond()
+      : in(NULL, "in"), a(boost::bind(&Diamond::funA, this, _1, _2), in, "a"),
+        b(boost::bind(&Diamond::funB, this, _1, _2), in, "b"),
+        out(boost::bind(&Diamond::funOut, this, _1, _2), a << b, "out"),
+        callsA(0), callsB(0), callsOut(0) {}
+
+  double &funA(double &res, int t) {
+    ++callsA;
+    res = 2 * in(t);
+    return res;
+  }
+  double &funB(double &res, int t) {
+    ++callsB;
+    res = in(t) + t;
+    return res;
+  }
+  double &funOut(double &res, int t) {
+    ++callsOut;
+    res = a(t) - b(t);
+    return res;
+  }
+};
+
+BOOST_AUTO_TEST_CASE(order) {
+  Diamond graph;
+  sigDouble_t source("source");
+  source.setConstant(3.);
+  graph.in.plug(&source);
+
+  dg::ExecutionPlan<int> plan;
+  plan.addSink(graph.out);
+  plan.compile();
+  BOOST_CHECK(plan.isValid());
+
+  // The plugged input is only traversed.
+  const dg::ExecutionPlan<int>::Signals &order = plan.getOrder();
+  BOOST_REQUIRE_EQUAL(order.size(), 4);
+  BOOST_CHECK_EQUAL(order[0], &source);
+  BOOST_CHECK_EQUAL(order[3], &graph.out);
+  BOOST_CHECK(std::find(order.begin(), order.end(), &graph.in) == order.end());
+}
+
+double &ramp(double &res, int t) {
+  res = 0.5 * t;
+  return res;
+}
+
+BOOST_AUTO_TEST_CASE(run_tick) {
+  Diamond graph, reference;
+  dg::Signal<double, int> source("source");
+  source.setFunction(&ramp);
+  graph.in.plug(&source);
+  reference.in.plug(&source);
+
+  dg::ExecutionPlan<int> plan;
+  plan.addSink(graph.out);
+  for (int t = 1; t < 10; ++t) {
+    plan.runTick(t);
+    BOOST_CHECK_EQUAL(graph.out.accessCopy(), reference.out(t));
+  }
+  BOOST_CHECK_EQUAL(graph.callsA, reference.callsA);
+  BOOST_CHECK_EQUAL(graph.callsB, reference.callsB);
+  BOOST_CHECK_EQUAL(graph.callsOut, reference.callsOut);
+  BOOST_CHECK_EQUAL(graph.callsOut, 9);
+}
+
+BOOST_AUTO_TEST_CASE(recompile) {
+  Diamond graph;
+  sigDouble_t source1("source1"), source2("source2");
+  source1.setConstant(3.);
+  source2.setConstant(5.);
+  graph.in.plug(&source1);
+
+  dg::ExecutionPlan<int> plan;
+  plan.addSink(graph.out);
+  plan.runTick(1);
+  BOOST_CHECK_EQUAL(graph.out.accessCopy(), 6. - 4.);
+  BOOST_CHECK(plan.isValid());
+
+  // Replugging the input invalidates the plan.
+  graph.in.plug(&source2);
+  BOOST_CHECK(!plan.isValid());
+  plan.runTick(2);
+  BOOST_CHECK(plan.isValid());
+  BOOST_CHECK_EQUAL(plan.getOrder()[0], &source2);
+  BOOST_CHECK_EQUAL(graph.out.accessCopy(), 10. - 7.);
+}
+
+BOOST_AUTO_TEST_CASE(cycle) {
+  sigPtr_t in(NULL, "in");
+  sigDouble_t out(in, "out");
+  in.plug(&out);
+
+  dg::ExecutionPlan<int> plan;
+  plan.addSink(out);
+  BOOST_CHECK_THROW(plan.compile(), dg::ExceptionSignal);
+}
+
+BOOST_AUTO_TEST_CASE(destroyed_sink) {
+  Diamond graph;
+  dg::Signal<double, int> source("source");
+  source.setFunction(&ramp);
+  graph.in.plug(&source);
+
+  dg::ExecutionPlan<int> plan;
+  plan.addSink(graph.out);
+  {
+    sigDouble_t sink(graph.out, "sink");
+    plan.addSink(sink);
+    plan.runTick(1);
+    BOOST_CHECK_EQUAL(plan.getOrder().size(), 5);
+  }
+  // The destroyed sink is no longer evaluated.
+  BOOST_CHECK_EQUAL(plan.getSinks().size(), 1);
+  plan.runTick(2);
+  BOOST_CHECK_EQUAL(plan.getOrder().size(), 4);
+  BOOST_CHECK_EQUAL(graph.out.accessCopy(), 2. - 3.);
+}
+
+BOOST_AUTO_TEST_CASE(levels) {
+  Diamond graph;
+  dg::Signal<double, int> source("source");
+  source.setFunction(&ramp);
+  graph.in.plug(&source);
+
+  dg::ExecutionPlan<int> plan;
+  plan.addSink(graph.out);
+  plan.compile();
+  BOOST_REQUIRE_EQUAL(plan.getNbLevels(), 3);
+  BOOST_CHECK_EQUAL(plan.getLevelBegin(0), 0);
+  BOOST_CHECK_EQUAL(plan.getLevelBegin(1), 1);
+  BOOST_CHECK_EQUAL(plan.getLevelBegin(2), 3);
+  BOOST_CHECK_EQUAL(plan.getLevelBegin(3), 4);
+}
+
+BOOST_AUTO_TEST_CASE(parallel) {
+  const std::size_t N = 16;
+  // A function signal is recomputed on each access: it can not be shared
+  // by the signals of one level. Use a constant updated at each tick.
+  dg::Signal<double, int> source("source"), referenceSource("reference");
+  std::vector<Diamond *> graphs, references;
+  dg::ExecutionPlan<int> plan;
+  for (std::size_t i = 0; i < N; ++i) {
+    graphs.push_back(new Diamond);
+    references.push_back(new Diamond);
+    graphs[i]->in.plug(&source);
+    references[i]->in.plug(&referenceSource);
+    plan.addSink(graphs[i]->out);
+  }
+
+  dg::ThreadPool pool(4);
+  BOOST_CHECK_EQUAL(pool.size(), 4);
+  for (int t = 1; t < 50; ++t) {
+    source.setConstant(0.5 * t);
+    referenceSource.setConstant(0.5 * t);
+    const unsigned long epoch = dg::SignalBase<int>::getUpdateEpoch();
+    plan.runTick(t, pool);
+    // The epoch is incremented once per level, not once per signal.
+    BOOST_CHECK_EQUAL(dg::SignalBase<int>::getUpdateEpoch() - epoch,
+                      plan.getNbLevels());
+    for (std::size_t i = 0; i < N; ++i)
+      BOOST_CHECK_EQUAL(graphs[i]->out.accessCopy(), references[i]->out(t));
+  }
+  BOOST_CHECK_EQUAL(plan.getNbLevels(), 3);
+  for (std::size_t i = 0; i < N; ++i) {
+    BOOST_CHECK_EQUAL(graphs[i]->callsA, 49);
+    BOOST_CHECK_EQUAL(graphs[i]->callsOut, 49);
+    delete graphs[i];
+    delete references[i];
+  }
+}
+
+// Signal computing twice its input, counting its computations.
+class Twice {
+public:
+  dg::Signal<double, int> &input;
+  sigDouble_t out;
+  int calls;
+
+  explicit Twice(dg::Signal<double, int> &input)
+      : input(input), out(boost::bind(&Twice::fun, this, _1, _2), input,
+                          "twice"),
+        calls(0) {}
+
+  double &fun(double &res, int t) {
+    ++calls;
+    res = 2 * input(t);
+    return res;
+  }
+};
+
+BOOST_AUTO_TEST_CASE(parallel_polled_dependency) {
+  const std::size_t N = 16;
+  // A VERSION_DEPENDENT signal depending on a TIME_DEPENDENT one does not
+  // push its updates: the signals of the next level all poll it.
+  dg::Signal<double, int> source("source");
+  source.setFunction(&ramp);
+  Twice clock(source), shared(clock.out);
+  shared.out.setDependencyType(dg::TimeDependency<int>::VERSION_DEPENDENT);
+  BOOST_CHECK(!shared.out.pushesUpdates());
+  std::vector<Diamond *> graphs;
+  dg::ExecutionPlan<int> plan;
+  for (std::size_t i = 0; i < N; ++i) {
+    graphs.push_back(new Diamond);
+    graphs[i]->in.plug(&shared.out);
+    plan.addSink(graphs[i]->out);
+  }
+
+  dg::ThreadPool pool(4);
+  for (int t = 1; t < 50; ++t) {
+    plan.runTick(t, pool);
+    // out(t) = 2 * 2 * t - (2 * t + t)
+    for (std::size_t i = 0; i < N; ++i)
+      BOOST_CHECK_EQUAL(graphs[i]->out.accessCopy(), t);
+  }
+  BOOST_CHECK_EQUAL(plan.getNbLevels(), 5);
+  BOOST_CHECK_EQUAL(shared.calls, 49);
+  BOOST_CHECK_GT(shared.out.getNbMemoizedQueries(), 0);
+  for (std::size_t i = 0; i < N; ++i) {
+    BOOST_CHECK_EQUAL(graphs[i]->callsA, 49);
+    BOOST_CHECK_EQUAL(graphs[i]->callsOut, 49);
+    delete graphs[i];
+  }
+}
+
+double &fail(double &, int) {
+  throw dg::ExceptionSignal(dg::ExceptionSignal::GENERIC, "failure");
+}
+
+BOOST_AUTO_TEST_CASE(parallel_exception) {
+  dg::ThreadPool pool(3);
+  sigDouble_t a(boost::bind(&fail, _1, _2), dg::sotNOSIGNAL, "a");
+  sigDouble_t b(boost::bind(&fail, _1, _2), dg::sotNOSIGNAL, "b");
+  dg::ExecutionPlan<int> plan;
+  plan.addSink(a);
+  plan.addSink(b);
+  BOOST_CHECK_THROW(plan.runTick(1, pool), dg::ExceptionSignal);
+}
+
+BOOST_AUTO_TEST_CASE(run_batch) {
+  Diamond graph, parallelGraph;
+  dg::Signal<double, int> source("source");
+  source.setFunction(&ramp);
+  graph.in.plug(&source);
+  parallelGraph.in.plug(&source);
+  graph.out.setHistoryDepth(10);
+  parallelGraph.out.setHistoryDepth(10);
+
+  dg::ExecutionPlan<int> plan, parallelPlan;
+  plan.addSink(graph.out);
+  parallelPlan.addSink(parallelGraph.out);
+  plan.runBatch(1, 10);
+  dg::ThreadPool pool(2);
+  parallelPlan.runBatch(1, 10, pool);
+
+  BOOST_CHECK_EQUAL(graph.callsOut, 10);
+  BOOST_CHECK_EQUAL(parallelGraph.callsOut, 10);
+  BOOST_CHECK_EQUAL(graph.out.getTime(), 10);
+  // out(t) = 2 * 0.5 * t - (0.5 * t + t)
+  for (int t = 1; t <= 10; ++t) {
+    BOOST_CHECK_EQUAL(graph.out.accessHistory(t), -0.5 * t);
+    BOOST_CHECK_EQUAL(parallelGraph.out.accessHistory(t), -0.5 * t);
+  }
+
+  // Empty range.
+  plan.runBatch(12, 11);
+  BOOST_CHECK_EQUAL(graph.callsOut, 10);
+}
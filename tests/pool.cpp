@@ -5,10 +5,18 @@
 #include <dynamic-graph/exception-factory.h>
 #include <dynamic-graph/factory.h>
 #include <dynamic-graph/pool.h>
+#include <dynamic-graph/signal-binary-io.h>
+#include <dynamic-graph/signal-handle.h>
 #include <dynamic-graph/signal-ptr.h>
 #include <dynamic-graph/signal-time-dependent.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 #define BOOST_TEST_MODULE pool
 
@@ -190,3 +198,327 @@ BOOST_AUTO_TEST_CASE(pool_display) {
 
   dg::PoolStorage::destroy();
 }
+
+double &timeAsDouble(double &res, int t) {
+  res = t;
+  return res;
+}
+
+BOOST_AUTO_TEST_CASE(pool_profile) {
+  MyEntity entity("profiled");
+  // A function is recomputed on each access, so that out_double is
+  // recomputed at each new time.
+  dg::Signal<double, int> source("source");
+  source.setFunction(&timeAsDouble);
+  entity.m_sigdSIN.plug(&source);
+
+  // Disabled by default.
+  entity.m_sigdTimeDepSOUT(1);
+  BOOST_CHECK_EQUAL(entity.m_sigdTimeDepSOUT.getProfile().getNbCalls(), 0);
+
+  dg::SignalProfile::enable();
+  dg::SignalProfile::setSamplingPeriod(2);
+  for (int t = 2; t < 6; ++t) {
+    entity.m_sigdTimeDepSOUT(t);
+    entity.m_sigdTimeDepSOUT(t);
+  }
+  dg::SignalProfile::enable(false);
+  dg::SignalProfile::setSamplingPeriod(1);
+
+  const dg::SignalProfile &profile = entity.m_sigdTimeDepSOUT.getProfile();
+  BOOST_CHECK_EQUAL(profile.getNbCalls(), 8);
+  BOOST_CHECK_EQUAL(profile.getNbRecomputes(), 4);
+  BOOST_CHECK_EQUAL(profile.getNbCacheHits(), 4);
+  BOOST_CHECK_EQUAL(profile.getNbTimed(), 2);
+  BOOST_CHECK(profile.getMaxTime() <= profile.getTotalTime());
+
+  std::ostringstream os;
+  dg::PoolStorage::getInstance()->writeProfile(os);
+  // The accesses to the plugged input are counted by source.
+  BOOST_CHECK(os.str().find("profiled: calls=8 recomputes=4 cacheHits=4") ==
+              0);
+  BOOST_CHECK(os.str().find("  out_double: calls=8 recomputes=4") !=
+              std::string::npos);
+
+  entity.m_sigdTimeDepSOUT.resetProfile();
+  BOOST_CHECK_EQUAL(profile.getNbCalls(), 0);
+  dg::PoolStorage::getInstance()->deregisterEntity("profiled");
+}
+
+BOOST_AUTO_TEST_CASE(signal_handle) {
+  dg::PoolStorage &pool = *dg::PoolStorage::getInstance();
+  dg::SignalHandle handle("handled.out_double");
+  BOOST_CHECK_EQUAL(handle.getEntityName(), "handled");
+  BOOST_CHECK_EQUAL(handle.getSignalName(), "out_double");
+  BOOST_CHECK(!handle.isValid());
+  BOOST_CHECK_THROW(handle.get(), dg::ExceptionFactory);
+  BOOST_CHECK_THROW(dg::SignalHandle("handled"), dg::ExceptionFactory);
+
+  MyEntity *entity = new MyEntity("handled");
+  BOOST_CHECK(handle.isValid());
+  BOOST_CHECK_EQUAL(&handle.get(), &entity->m_sigdTimeDepSOUT);
+  BOOST_CHECK_EQUAL(&pool.getSignal(" handled.out_double "),
+                    &entity->m_sigdTimeDepSOUT);
+  BOOST_CHECK_THROW(pool.getSignal("handled"), dg::ExceptionFactory);
+
+  // The lookup is only done again when the registry changes.
+  const unsigned long revision = dg::PoolStorage::getRegistryRevision();
+  BOOST_CHECK_EQUAL(handle->getName(), entity->m_sigdTimeDepSOUT.getName());
+  BOOST_CHECK_EQUAL(dg::PoolStorage::getRegistryRevision(), revision);
+
+  // The handle follows the signal registered under its name.
+  pool.deregisterEntity("handled");
+  delete entity;
+  BOOST_CHECK(dg::PoolStorage::getRegistryRevision() != revision);
+  BOOST_CHECK_THROW(handle.get(), dg::ExceptionFactory);
+  entity = new MyEntity("handled");
+  BOOST_CHECK_EQUAL(&(*handle), &entity->m_sigdTimeDepSOUT);
+  pool.deregisterEntity("handled");
+  delete entity;
+}
+
+BOOST_AUTO_TEST_CASE(pool_snapshot) {
+  dg::PoolStorage &pool = *dg::PoolStorage::getInstance();
+  const dg::PoolStorage::EntitiesSnapshot before = pool.getEntitySnapshot();
+
+  // A monitoring thread enumerates the entities and their signals while
+  // they are created and deregistered.
+  std::atomic<bool> stop(false);
+  std::atomic<unsigned long> nbSignals(0);
+  std::thread monitor([&]() {
+    while (!stop) {
+      dg::PoolStorage::EntitiesSnapshot entities = pool.getEntitySnapshot();
+      for (dg::PoolStorage::Entities::const_iterator it = entities->begin();
+           it != entities->end(); ++it)
+        nbSignals += it->second->getSignalSnapshot()->size();
+    }
+  });
+  std::vector<MyEntity *> entities;
+  for (int i = 0; i < 50; ++i) {
+    std::ostringstream name;
+    name << "monitored" << i;
+    entities.push_back(new MyEntity(name.str()));
+    if (i % 2)
+      pool.deregisterEntity(name.str());
+  }
+  const dg::PoolStorage::EntitiesSnapshot during = pool.getEntitySnapshot();
+  for (std::size_t i = 0; i < entities.size(); i += 2)
+    pool.deregisterEntity(entities[i]->getName());
+  stop = true;
+  monitor.join();
+  // The entities are only deleted once no thread uses them.
+  for (std::size_t i = 0; i < entities.size(); ++i)
+    delete entities[i];
+
+  BOOST_CHECK_EQUAL(during->size(), before->size() + 25);
+  BOOST_CHECK(during->find("monitored0") != during->end());
+  BOOST_CHECK(during->find("monitored1") == during->end());
+  BOOST_CHECK_EQUAL(pool.getEntitySnapshot()->size(), before->size());
+}
+
+// Registers and deregisters nb entities, in seconds.
+static double churnEntities(int nb) {
+  dg::PoolStorage &pool = *dg::PoolStorage::getInstance();
+  std::vector<MyEntity *> entities;
+  entities.reserve(nb);
+  const std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  for (int i = 0; i < nb; ++i) {
+    std::ostringstream name;
+    name << "churned" << i;
+    entities.push_back(new MyEntity(name.str()));
+  }
+  for (int i = 0; i < nb; ++i) {
+    pool.deregisterEntity(entities[i]->getName());
+    delete entities[i];
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+BOOST_AUTO_TEST_CASE(pool_snapshot_scaling) {
+  dg::PoolStorage &pool = *dg::PoolStorage::getInstance();
+  // Without reads, the registry changes do not copy the maps.
+  double small = 1e9, large = 1e9;
+  for (int i = 0; i < 3; ++i) {
+    small = std::min(small, churnEntities(1000));
+    large = std::min(large, churnEntities(4000));
+  }
+  BOOST_CHECK_LT(large, 8 * small + 1e-3);
+
+  // The snapshot is only copied again after a change.
+  const dg::PoolStorage::EntitiesSnapshot first = pool.getEntitySnapshot();
+  BOOST_CHECK(pool.getEntitySnapshot() == first);
+  MyEntity entity("snapshotted");
+  const dg::PoolStorage::EntitiesSnapshot second = pool.getEntitySnapshot();
+  BOOST_CHECK(second != first);
+  BOOST_CHECK(second->find("snapshotted") != second->end());
+  BOOST_CHECK(entity.getSignalSnapshot() == entity.getSignalSnapshot());
+  BOOST_CHECK_EQUAL(entity.getSignalSnapshot()->size(), 2);
+  pool.deregisterEntity("snapshotted");
+}
+
+BOOST_AUTO_TEST_CASE(pool_snapshot_restore) {
+  dg::PoolStorage &pool = *dg::PoolStorage::getInstance();
+  dg::FactoryStorage &factory = *dg::FactoryStorage::getInstance();
+  MyEntity *first =
+      static_cast<MyEntity *>(factory.newEntity("MyEntity", "snapFirst"));
+  MyEntity *second =
+      static_cast<MyEntity *>(factory.newEntity("MyEntity", "snapSecond"));
+  first->m_sigdSIN.setConstant(3.5);
+  first->m_sigdTimeDepSOUT.setPeriodTime(2);
+  second->m_sigdSIN.plug(&first->m_sigdTimeDepSOUT);
+
+  std::stringstream snapshot;
+  pool.writeSnapshot(snapshot);
+  pool.deregisterEntity("snapFirst");
+  pool.deregisterEntity("snapSecond");
+  delete second;
+  delete first;
+
+  pool.readSnapshot(snapshot);
+  first = static_cast<MyEntity *>(&pool.getEntity("snapFirst"));
+  second = static_cast<MyEntity *>(&pool.getEntity("snapSecond"));
+  BOOST_CHECK_EQUAL(first->getClassName(), "MyEntity");
+  BOOST_CHECK_EQUAL(first->m_sigdSIN.accessCopy(), 3.5);
+  BOOST_CHECK_EQUAL(first->m_sigdTimeDepSOUT.getPeriodTime(), 2);
+  BOOST_CHECK(second->m_sigdSIN.getPtr() == &first->m_sigdTimeDepSOUT);
+  BOOST_CHECK_EQUAL(second->m_sigdTimeDepSOUT(1), 3.5);
+
+  // Restoring again reuses the existing entities.
+  snapshot.clear();
+  snapshot.seekg(0);
+  pool.readSnapshot(snapshot);
+  BOOST_CHECK(&pool.getEntity("snapFirst") == first);
+
+  std::istringstream garbage("not a snapshot");
+  BOOST_CHECK_THROW(pool.readSnapshot(garbage), std::exception);
+
+  pool.deregisterEntity("snapFirst");
+  pool.deregisterEntity("snapSecond");
+  delete second;
+  delete first;
+
+  // Values of variable size.
+  dg::Matrix m(2, 3);
+  m << 1, 2, 3, 4, 5, 6;
+  std::stringstream bin;
+  dg::signal_binary_io<dg::Matrix>::write(m, bin);
+  dg::signal_binary_io<std::string>::write("a string", bin);
+  BOOST_CHECK(dg::signal_binary_io<dg::Matrix>::read(bin) == m);
+  BOOST_CHECK_EQUAL(dg::signal_binary_io<std::string>::read(bin), "a string");
+  BOOST_CHECK_THROW(dg::signal_binary_io<dg::Matrix>::read(bin),
+                    dg::ExceptionSignal);
+
+  // Sizes which do not match the data or the type.
+  std::stringstream truncated;
+  dg::binary::write<std::uint32_t>(truncated, 0xffffffff);
+  truncated << "short";
+  BOOST_CHECK_THROW(dg::binary::readString(truncated), dg::ExceptionSignal);
+  std::stringstream huge;
+  dg::binary::write<std::uint32_t>(huge, 0xffffffff);
+  dg::binary::write<std::uint32_t>(huge, 0xffffffff);
+  BOOST_CHECK_THROW(dg::signal_binary_io<dg::Matrix>::read(huge),
+                    dg::ExceptionSignal);
+  std::stringstream vector3;
+  dg::signal_binary_io<dg::Vector>::write(dg::Vector::Zero(4), vector3);
+  BOOST_CHECK_THROW(dg::signal_binary_io<Eigen::Vector3d>::read(vector3),
+                    dg::ExceptionSignal);
+}
+
+BOOST_AUTO_TEST_CASE(pool_graph_json) {
+  dg::PoolStorage &pool = *dg::PoolStorage::getInstance();
+  MyEntity *first = new MyEntity("jsonFirst");
+  MyEntity *second = new MyEntity("jsonSecond");
+  first->m_sigdSIN.setConstant(1.);
+  second->m_sigdSIN.plug(&first->m_sigdTimeDepSOUT);
+  dg::SignalProfile::enable();
+  second->m_sigdTimeDepSOUT(1);
+  dg::SignalProfile::enable(false);
+
+  std::ostringstream os;
+  pool.writeGraphJson(os);
+  const std::string json = os.str();
+  BOOST_CHECK(json.find("{\"name\": \"jsonFirst\", \"class\": \"MyEntity\"") !=
+              std::string::npos);
+  BOOST_CHECK(json.find("{\"name\": \"out_double\", \"id\": "
+                        "\"MyEntity(jsonSecond)::input(double)::out_double\", "
+                        "\"time\": 1, \"calls\": 1, \"recomputes\": 1") !=
+              std::string::npos);
+  BOOST_CHECK(json.find("{\"from\": "
+                        "\"MyEntity(jsonFirst)::input(double)::out_double\", "
+                        "\"to\": "
+                        "\"MyEntity(jsonSecond)::input(double)::in_double\", "
+                        "\"type\": \"plug\"}") != std::string::npos);
+  BOOST_CHECK(json.find("{\"from\": "
+                        "\"MyEntity(jsonSecond)::input(double)::in_double\", "
+                        "\"to\": "
+                        "\"MyEntity(jsonSecond)::input(double)::out_double\", "
+                        "\"type\": \"dependency\"}") != std::string::npos);
+
+  pool.deregisterEntity("jsonFirst");
+  pool.deregisterEntity("jsonSecond");
+  delete second;
+  delete first;
+}
+
+BOOST_AUTO_TEST_CASE(pool_arena) {
+  BOOST_CHECK(dg::PoolStorage::getArena() == NULL);
+  MyEntity *onHeap = new MyEntity("arenaHeap");
+
+  dg::PoolStorage &pool = *dg::PoolStorage::getInstance();
+  pool.enableArena(1 << 16);
+  dg::Arena *arena = dg::PoolStorage::getArena();
+  BOOST_REQUIRE(arena != NULL);
+  pool.enableArena();
+  BOOST_CHECK_EQUAL(dg::PoolStorage::getArena(), arena);
+  BOOST_CHECK_EQUAL(arena->getSize(), 0);
+
+  MyEntity *first = new MyEntity("arenaFirst");
+  const std::size_t size = arena->getSize();
+  BOOST_CHECK(size >= sizeof(MyEntity));
+  BOOST_CHECK(arena->contains(first));
+  BOOST_CHECK(!arena->contains(onHeap));
+  MyEntity *second = new MyEntity("arenaSecond");
+  BOOST_CHECK_EQUAL(arena->getSize(), 2 * size);
+  BOOST_CHECK_EQUAL(arena->getNbBlocks(), 1);
+  // The second entity follows the first one in memory.
+  BOOST_CHECK_EQUAL(reinterpret_cast<char *>(second) -
+                        reinterpret_cast<char *>(first),
+                    static_cast<std::ptrdiff_t>(size));
+
+  // A signal allocated with new is placed in the arena too.
+  dg::Signal<double, int> *sig =
+      new dg::Signal<double, int>("arenaSignal(double)");
+  BOOST_CHECK(arena->getSize() > 2 * size);
+  sig->setConstant(1.);
+  second->m_sigdSIN.plug(sig);
+  BOOST_CHECK_EQUAL(second->m_sigdSIN.accessCopy(), 1.);
+  delete sig;
+  BOOST_CHECK(!second->m_sigdSIN.isPlugged());
+
+  // Larger allocations get a block of their own.
+  arena->allocate(1 << 17);
+  BOOST_CHECK_EQUAL(arena->getNbBlocks(), 2);
+  BOOST_CHECK(arena->allocate(1) != NULL);
+  BOOST_CHECK_EQUAL(arena->getNbBlocks(), 2);
+  void *aligned = arena->allocate(1, 64);
+  BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(aligned) % 64, 0);
+
+  // Placement new is not hidden by the operator new of the class.
+  alignas(dg::Signal<double, int>) char
+      buffer[sizeof(dg::Signal<double, int>)];
+  sig = new (buffer) dg::Signal<double, int>("arenaPlaced(double)");
+  BOOST_CHECK(!arena->contains(sig));
+  sig->~Signal();
+
+  pool.deregisterEntity("arenaHeap");
+  delete onHeap;
+  pool.deregisterEntity("arenaFirst");
+  delete first;
+
+  // The entities left are deleted by the pool, before the arena is freed.
+  dg::PoolStorage::destroy();
+  BOOST_CHECK(dg::PoolStorage::getArena() == NULL);
+}
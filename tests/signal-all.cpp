@@ -3,11 +3,13 @@
 //
 
 #include <boost/foreach.hpp>
+#include <boost/thread/thread.hpp>
 
 #include <dynamic-graph/debug.h>
 #include <dynamic-graph/factory.h>
 #include <dynamic-graph/signal-array.h>
 #include <dynamic-graph/signal-caster.h>
+#include <dynamic-graph/signal-ptr.h>
 #include <dynamic-graph/tracer.h>
 
 #include <assert.h>
@@ -47,6 +49,15 @@ BOOST_AUTO_TEST_CASE(test_array) {
   sigA.operator<<(sigB);
   SignalArray_const<int> sig_C(sigA);
   BOOST_CHECK_EQUAL(sigA.getSize(), sig_C.getSize());
+
+  // More signals than stored inline.
+  SignalArray_const<int> sigLong(sigBa << sigB);
+  for (std::size_t i = 0; i < 2 * SignalArray_const<int>::INLINE_SIZE; ++i)
+    sigLong << sigBa;
+  BOOST_CHECK_EQUAL(2 + 2 * SignalArray_const<int>::INLINE_SIZE,
+                    sigLong.getSize());
+  BOOST_CHECK_EQUAL(&sigB, &sigLong[1]);
+  BOOST_CHECK_EQUAL(&sigBa, &sigLong[sigLong.getSize() - 1]);
 }
 
 BOOST_AUTO_TEST_CASE(test_base) {
@@ -176,3 +187,131 @@ BOOST_AUTO_TEST_CASE(test_cast_helper) {
   std::istringstream aiss("test");
   signal_io<std::string>::cast(aiss);
 }
+
+void publishRamp(Signal<dynamicgraph::Vector, int> *sig, int n) {
+  dynamicgraph::Vector v(100);
+  for (int i = 1; i <= n; ++i) {
+    v.setConstant(i);
+    sig->publish(v);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_lock_free_reference) {
+  Signal<dynamicgraph::Vector, int> sig("lockfree");
+  BOOST_CHECK_THROW(sig.publish(dynamicgraph::Vector::Zero(100)),
+                    ExceptionSignal);
+  sig.setReferenceLockFree();
+  output_test_stream output;
+  sig.display(output);
+  BOOST_CHECK(output.is_equal("Sig:lockfree (Type RefLockFree)"));
+
+  // Nothing published yet.
+  BOOST_CHECK_EQUAL(sig.access(0).size(), 0);
+
+  const int N = 10000;
+  boost::thread publisher(&publishRamp, &sig, N);
+  double last = 0;
+  for (int t = 1; last < N; ++t) {
+    const dynamicgraph::Vector &v = sig.access(t);
+    if (v.size() == 0)
+      continue;
+    // Values are never torn, and never go back in time.
+    BOOST_REQUIRE_EQUAL(v.minCoeff(), v.maxCoeff());
+    BOOST_REQUIRE_GE(v[0], last);
+    last = v[0];
+    BOOST_CHECK_EQUAL(sig.getTime(), t);
+  }
+  publisher.join();
+  BOOST_CHECK_EQUAL(sig.accessCopy()[0], N);
+}
+
+BOOST_AUTO_TEST_CASE(test_move_constant) {
+  SignalPtr<dynamicgraph::Vector, int> sig(NULL, "move");
+  dynamicgraph::Vector v = dynamicgraph::Vector::Constant(1000, 2.);
+  const double *data = v.data();
+  sig.setConstant(std::move(v));
+  // The buffer has been moved into the signal instead of being copied.
+  BOOST_CHECK_EQUAL(sig.accessCopy().data(), data);
+  BOOST_CHECK_EQUAL(sig.access(1)[999], 2.);
+}
+
+BOOST_AUTO_TEST_CASE(test_shared_value) {
+  typedef Signal<dynamicgraph::Vector, int> sigVector_t;
+  sigVector_t sig("shared");
+  BOOST_CHECK_THROW(sig.setSharedConstant(sigVector_t::SharedValue()),
+                    ExceptionSignal);
+
+  sigVector_t::SharedValue value(
+      new dynamicgraph::Vector(dynamicgraph::Vector::Constant(1000, 1.)));
+  sig.setSharedConstant(value);
+  BOOST_CHECK_EQUAL(&sig.access(1), value.get());
+  BOOST_CHECK_EQUAL(value.use_count(), 2);
+
+  // The provider replaces the shared value instead of modifying it.
+  sigVector_t::SharedValue provider = value;
+  sig.setSharedReference(&provider);
+  output_test_stream output;
+  sig.display(output);
+  BOOST_CHECK(output.is_equal("Sig:shared (Type RefShared)"));
+  for (int t = 2; t < 5; ++t) {
+    provider.reset(
+        new dynamicgraph::Vector(dynamicgraph::Vector::Constant(1000, t)));
+    const dynamicgraph::Vector &res = sig.access(t);
+    BOOST_CHECK_EQUAL(&res, provider.get());
+    BOOST_CHECK_EQUAL(res[0], t);
+  }
+  // The signal only holds the last value it accessed.
+  BOOST_CHECK_EQUAL(value.use_count(), 1);
+
+  // Going back to a copied value releases the shared one.
+  sig.setConstant(dynamicgraph::Vector::Zero(3));
+  BOOST_CHECK_EQUAL(provider.use_count(), 1);
+  BOOST_CHECK_EQUAL(sig.accessCopy().size(), 3);
+
+  // The shared reference cannot be null.
+  sigVector_t::SharedValue empty;
+  BOOST_CHECK_THROW(sig.setSharedReference(NULL), ExceptionSignal);
+  BOOST_CHECK_THROW(sig.setSharedReference(&empty), ExceptionSignal);
+  sig.setSharedReference(&provider);
+  provider.reset();
+  BOOST_CHECK_THROW(sig.access(6), ExceptionSignal);
+}
+
+double &twice(double &res, int t) {
+  res = 2. * t;
+  return res;
+}
+
+BOOST_AUTO_TEST_CASE(test_history) {
+  Signal<double, int> sig("history");
+  BOOST_CHECK_EQUAL(sig.getHistoryDepth(), 0);
+  BOOST_CHECK_THROW(sig.history(0), ExceptionSignal);
+
+  sig.setFunction(&twice);
+  sig.setHistoryDepth(3);
+  BOOST_CHECK_EQUAL(sig.getHistoryDepth(), 3);
+  // Nothing computed yet.
+  BOOST_CHECK_THROW(sig.history(0), ExceptionSignal);
+
+  for (int t = 1; t <= 5; ++t)
+    sig.access(2 * t);
+  BOOST_CHECK_EQUAL(sig.history(0), 20.);
+  BOOST_CHECK_EQUAL(sig.history(1), 16.);
+  BOOST_CHECK_EQUAL(sig.history(2), 12.);
+  BOOST_CHECK_THROW(sig.history(3), ExceptionSignal);
+
+  // Latest value obtained at or before the given time.
+  BOOST_CHECK_EQUAL(sig.accessHistory(10), 20.);
+  BOOST_CHECK_EQUAL(sig.accessHistory(15), 20.);
+  BOOST_CHECK_EQUAL(sig.accessHistory(7), 12.);
+  BOOST_CHECK_THROW(sig.accessHistory(5), ExceptionSignal);
+  // The signal is not recomputed.
+  BOOST_CHECK_EQUAL(sig.getTime(), 10);
+
+  sig.setConstant(-1.);
+  BOOST_CHECK_EQUAL(sig.history(0), -1.);
+  BOOST_CHECK_EQUAL(sig.history(1), 20.);
+
+  sig.setHistoryDepth(0);
+  BOOST_CHECK_THROW(sig.history(0), ExceptionSignal);
+}
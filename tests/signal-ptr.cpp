@@ -10,6 +10,7 @@
 #include <dynamic-graph/factory.h>
 #include <dynamic-graph/pool.h>
 #include <dynamic-graph/signal-base.h>
+#include <dynamic-graph/signal-input.h>
 #include <dynamic-graph/signal-ptr.h>
 #include <dynamic-graph/signal-time-dependent.h>
 #include <dynamic-graph/signal.h>
@@ -315,3 +316,264 @@ BOOST_AUTO_TEST_CASE(set_signal_string) {
     BOOST_CHECK(!"Tentative to set signal to empty string");
   }
 }
+
+// Abstract signals giving access to a double, either through its type id or
+// only through checkCompatibility().
+class AbstractDouble : public SignalBase<int> {
+public:
+  AbstractDouble(const std::string &name, bool typeId)
+      : SignalBase<int>(name), value(3.), typeId(typeId), nbThrows(0) {}
+
+  virtual void recompute(const int &) {}
+
+  virtual void checkCompatibility() {
+    ++nbThrows;
+    throw &value;
+  }
+  virtual void *getCompatibleValue(const std::type_info &type) {
+    return (typeId && type == typeid(double)) ? &value : NULL;
+  }
+
+  double value;
+  bool typeId;
+  int nbThrows;
+};
+
+BOOST_AUTO_TEST_CASE(plug_abstract) {
+  SignalPtr<double, int> in(NULL, "in");
+  AbstractDouble byTypeId("byTypeId", true), byThrow("byThrow", false);
+
+  in.plug(&byTypeId);
+  BOOST_CHECK_EQUAL(byTypeId.nbThrows, 0);
+  BOOST_CHECK_EQUAL(in.access(1), 3.);
+
+  in.plug(&byThrow);
+  BOOST_CHECK_EQUAL(byThrow.nbThrows, 1);
+  BOOST_CHECK_EQUAL(in.access(2), 3.);
+
+  // A plugged SignalPtr forwards the type of the signal it is plugged on.
+  SignalPtr<double, int> chained(NULL, "chained");
+  in.plug(&byTypeId);
+  chained.plug(&in);
+  BOOST_CHECK_EQUAL(in.getCompatibleValue(typeid(double)), &byTypeId.value);
+  BOOST_CHECK(in.getCompatibleValue(typeid(int)) == NULL);
+
+  SignalPtr<int, int> wrongType(NULL, "wrongType");
+  BOOST_CHECK_THROW(wrongType.plug(&byTypeId), ExceptionSignal);
+}
+
+// Values of a class derived from the type of the port.
+struct BaseValue {
+  BaseValue() : id(1) {}
+  virtual ~BaseValue() {}
+  int id;
+};
+struct DerivedValue : public BaseValue {
+  DerivedValue() { id = 2; }
+};
+std::ostream &operator<<(std::ostream &os, const BaseValue &v) {
+  return os << v.id;
+}
+std::istream &operator>>(std::istream &is, BaseValue &v) { return is >> v.id; }
+
+// Signal counting the calls to checkCompatibility().
+class CountingDouble : public Signal<double, int> {
+public:
+  explicit CountingDouble(const std::string &name)
+      : Signal<double, int>(name), nbThrows(0) {}
+  virtual void checkCompatibility() {
+    ++nbThrows;
+    Signal<double, int>::checkCompatibility();
+  }
+  int nbThrows;
+};
+
+// Signal of a derived class counting the calls to checkCompatibility().
+class CountingDerived : public Signal<DerivedValue, int> {
+public:
+  explicit CountingDerived(const std::string &name)
+      : Signal<DerivedValue, int>(name), nbThrows(0) {}
+  virtual void checkCompatibility() {
+    ++nbThrows;
+    Signal<DerivedValue, int>::checkCompatibility();
+  }
+  int nbThrows;
+};
+
+BOOST_AUTO_TEST_CASE(plug_conversion) {
+  // The type of a signal is known: an incompatible plug throws only the
+  // exception of the plug.
+  CountingDouble counting("counting");
+  counting.setConstant(1.);
+  SignalPtr<int, int> wrongType(NULL, "wrongType");
+  BOOST_CHECK_THROW(wrongType.plug(&counting), ExceptionSignal);
+  BOOST_CHECK_EQUAL(counting.nbThrows, 0);
+
+  // A signal of a derived class plugs into a port of its base class
+  // without registration, through checkCompatibility().
+  CountingDerived derived("derived");
+  derived.setConstant(DerivedValue());
+  SignalPtr<BaseValue, int> base(NULL, "base");
+  base.plug(&derived);
+  BOOST_CHECK(base.isAbstractPluged());
+  BOOST_CHECK_EQUAL(base.access(1).id, 2);
+  BOOST_CHECK_EQUAL(derived.nbThrows, 1);
+
+  // A registered conversion does not throw.
+  SignalCompatibility::getInstance()
+      .registerConversion<DerivedValue, BaseValue>();
+  SignalPtr<BaseValue, int> registered(NULL, "registered");
+  registered.plug(&derived);
+  BOOST_CHECK_EQUAL(registered.access(1).id, 2);
+  BOOST_CHECK_EQUAL(derived.nbThrows, 1);
+}
+
+BOOST_AUTO_TEST_CASE(plug_notifications) {
+  SignalPtr<double, int> in(NULL, "in");
+  SignalTimeDependent<double, int> out(in, "out");
+  out.setDependencyType(TimeDependency<int>::VERSION_DEPENDENT);
+  {
+    Signal<double, int> source("source");
+    source.setConstant(1.);
+    in.plug(&source);
+    BOOST_CHECK_EQUAL(source.getDependents().size(), 1);
+    BOOST_CHECK(out.pushesUpdates());
+    out.access(1);
+    BOOST_CHECK(!out.TimeDependency<int>::dirty);
+    // Notifications go through the plugged input.
+    source.setConstant(2.);
+    BOOST_CHECK(out.TimeDependency<int>::dirty);
+
+    in.unplug();
+    BOOST_CHECK(source.getDependents().empty());
+    in.plug(&source);
+  }
+  // The input is unplugged when its signal is destroyed.
+  BOOST_CHECK(!in.isAbstractPluged());
+}
+
+double &times10(double &res, int t, SignalPtr<double, int> &in) {
+  res = 10 * in(t);
+  return res;
+}
+
+BOOST_AUTO_TEST_CASE(replug_notifications) {
+  SignalPtr<double, int> in(NULL, "in");
+  SignalTimeDependent<double, int> out(
+      boost::bind(&times10, _1, _2, boost::ref(in)), in, "out");
+  out.setDependencyType(TimeDependency<int>::VERSION_DEPENDENT);
+  Signal<double, int> a("a"), b("b");
+  a.setConstant(1.);
+  b.setConstant(2.);
+  in.plug(&a);
+  BOOST_CHECK_EQUAL(out.access(1), 10.);
+  BOOST_CHECK_EQUAL(out.access(2), 10.);
+  // The dependents of the input are notified that its value has changed.
+  in.plug(&b);
+  BOOST_CHECK(out.TimeDependency<int>::dirty);
+  BOOST_CHECK_EQUAL(out.access(3), 20.);
+}
+
+double &times2(double &res, int t, SignalInput<double, int> &in) {
+  res = 2 * in(t);
+  return res;
+}
+
+BOOST_AUTO_TEST_CASE(signal_input) {
+  typedef Eigen::Matrix<double, 12, 12> Matrix12;
+  // A plugged input does not hold any value.
+  BOOST_CHECK_LT(sizeof(SignalInput<Matrix12, int>), sizeof(Matrix12));
+
+  SignalInput<double, int> in("in");
+  BOOST_CHECK(!in.isPlugged());
+  BOOST_CHECK_THROW(in.access(0), ExceptionSignal);
+  in.setConstantDefault(1.);
+  BOOST_CHECK(!in.isPlugged());
+  BOOST_CHECK_EQUAL(in.access(0), 1.);
+
+  SignalTimeDependent<double, int> out(
+      boost::bind(&times2, _1, _2, boost::ref(in)), in, "out");
+  out.setDependencyType(TimeDependency<int>::VERSION_DEPENDENT);
+  {
+    Signal<double, int> source("source");
+    source.setConstant(2.);
+    in.plug(&source);
+    BOOST_CHECK(in.getPtr() == &source);
+    BOOST_CHECK_EQUAL(source.getDependents().size(), 1);
+    BOOST_CHECK_EQUAL(out.access(1), 4.);
+    source.setConstant(3.);
+    BOOST_CHECK(out.TimeDependency<int>::dirty);
+    BOOST_CHECK_EQUAL(out.access(2), 6.);
+
+    // Inputs can be chained.
+    SignalInput<double, int> chained("chained");
+    chained.plug(&in);
+    BOOST_CHECK_EQUAL(chained.access(2), 3.);
+    BOOST_CHECK_THROW(chained.getPtr(), ExceptionSignal);
+    BOOST_CHECK_THROW(chained.plug(&chained), ExceptionSignal);
+  }
+  // The input is unplugged when its signal is destroyed, and falls back to
+  // its default value.
+  BOOST_CHECK(!in.isPlugged());
+  BOOST_CHECK_EQUAL(in.access(3), 1.);
+
+  // Set as a signal.
+  in = 5.;
+  BOOST_CHECK(in.isPlugged());
+  BOOST_CHECK_EQUAL(out.access(4), 10.);
+  std::istringstream iss("7");
+  in.set(iss);
+  BOOST_CHECK_EQUAL(out.access(5), 14.);
+  std::ostringstream oss;
+  in.get(oss);
+  BOOST_CHECK_EQUAL(oss.str(), "7");
+
+  AbstractDouble byTypeId("byTypeId", true);
+  in.plug(&byTypeId);
+  BOOST_CHECK_EQUAL(in.access(6), 3.);
+  SignalInput<int, int> wrongType("wrongType");
+  BOOST_CHECK_THROW(wrongType.plug(&byTypeId), ExceptionSignal);
+}
+
+BOOST_AUTO_TEST_CASE(plug_chain) {
+  Signal<double, int> source("source"), other("other");
+  source.setConstant(1.);
+  other.setConstant(2.);
+  SignalPtr<double, int> a(NULL, "a"), b(NULL, "b"), c(NULL, "c");
+  c.plug(&source);
+  b.plug(&c);
+  a.plug(&b);
+  // The chain is resolved when plugging.
+  BOOST_CHECK(a.getResolvedPtr() == &source);
+  BOOST_CHECK(b.getResolvedPtr() == &source);
+  BOOST_CHECK_EQUAL(a.access(1), 1.);
+
+  // and when an intermediate port is plugged elsewhere.
+  c.plug(&other);
+  BOOST_CHECK(a.getResolvedPtr() == &other);
+  BOOST_CHECK_EQUAL(a.access(2), 2.);
+
+  // A port set to a value ends the chain.
+  c.setConstant(3.);
+  BOOST_CHECK(a.getResolvedPtr() == &c);
+  BOOST_CHECK_EQUAL(a.access(3), 3.);
+
+  // An unplugged port too, with its default value.
+  b.unplug();
+  b.setConstantDefault(4.);
+  BOOST_CHECK(a.getResolvedPtr() == &b);
+  BOOST_CHECK_EQUAL(a.access(4), 4.);
+
+  b.plug(&c);
+  c.plug(&source);
+  BOOST_CHECK(a.getResolvedPtr() == &source);
+  {
+    SignalPtr<double, int> d(NULL, "d");
+    d.plug(&source);
+    c.plug(&d);
+    BOOST_CHECK(a.getResolvedPtr() == &source);
+  }
+  // c is unplugged when d is destroyed.
+  BOOST_CHECK(c.getResolvedPtr() == NULL);
+  BOOST_CHECK(a.getResolvedPtr() == &c);
+}
@@ -234,3 +234,196 @@ BOOST_AUTO_TEST_CASE(signaltimedependent) {
   }
   BOOST_CHECK(true);
 }
+
+double &twice(double &res, int t) {
+  res = 2 * t;
+  return res;
+}
+
+BOOST_AUTO_TEST_CASE(signal_function) {
+  DummyClass<double> pro("pro");
+  sigDouble_t sig(SIGNAL_FUNCTION(double, int, DummyClass<double>, fun, &pro),
+                  dynamicgraph::sotNOSIGNAL, "sig");
+  output_test_stream output;
+  sig.display(output);
+  BOOST_CHECK(output.is_equal("Sig:sig (Type Fun)"));
+
+  BOOST_CHECK_EQUAL(sig(3), 3.);
+  BOOST_CHECK_EQUAL(pro.call, 1);
+  // Not recomputed at the same time.
+  BOOST_CHECK_EQUAL(sig(3), 3.);
+  BOOST_CHECK_EQUAL(pro.call, 1);
+  sig.setDependencyType(dynamicgraph::TimeDependency<int>::ALWAYS_READY);
+  BOOST_CHECK_EQUAL(sig(4), 8.);
+
+  dynamicgraph::Signal<double, int> sigFree("free");
+  sigFree.setFunction(
+      dynamicgraph::makeSignalFunction<double, int, double &(*)(double &, int),
+                                       &twice>());
+  BOOST_CHECK_EQUAL(sigFree(5), 10.);
+  // Back to a boost::function.
+  sigFree.setFunction(boost::bind(&DummyClass<double>::fun, &pro, _1, _2));
+  BOOST_CHECK_EQUAL(sigFree(5), 15.);
+}
+
+BOOST_AUTO_TEST_CASE(version_dependent) {
+  typedef dynamicgraph::TimeDependency<int> TimeDependency;
+  dynamicgraph::Signal<double, int> gain("gain");
+  gain.setConstant(2.);
+  DummyClass<double> pro1("pro1"), pro2("pro2");
+  sigDouble_t sig1(boost::bind(&DummyClass<double>::fun, &pro1, _1, _2), gain,
+                   "sig1");
+  sigDouble_t sig2(boost::bind(&DummyClass<double>::fun, &pro2, _1, _2), sig1,
+                   "sig2");
+  pro2.add(sig1);
+  sig1.setDependencyType(TimeDependency::VERSION_DEPENDENT);
+  sig2.setDependencyType(TimeDependency::VERSION_DEPENDENT);
+  BOOST_CHECK(sig1.pushesUpdates());
+  BOOST_CHECK(sig2.pushesUpdates());
+  BOOST_REQUIRE_EQUAL(gain.getDependents().size(), 1);
+  BOOST_CHECK_EQUAL(gain.getDependents()[0], &sig1);
+
+  // Nothing upstream is modified: computed once.
+  for (int t = 1; t < 10; ++t)
+    sig2(t);
+  BOOST_CHECK_EQUAL(pro1.call, 1);
+  BOOST_CHECK_EQUAL(pro2.call, 1);
+  const unsigned long version = sig2.getVersion();
+
+  // Setting the constant marks the whole sub-graph dirty.
+  gain.setConstant(3.);
+  BOOST_CHECK(sig1.TimeDependency::dirty);
+  BOOST_CHECK(sig2.TimeDependency::dirty);
+  sig2(10);
+  BOOST_CHECK_EQUAL(pro1.call, 2);
+  BOOST_CHECK_EQUAL(pro2.call, 2);
+  BOOST_CHECK_EQUAL(sig2.getVersion(), version + 1);
+  sig2(11);
+  BOOST_CHECK_EQUAL(pro2.call, 2);
+
+  // A function does not push its updates: it is polled.
+  dynamicgraph::Signal<double, int> input("input");
+  input.setFunction(&twice);
+  sig1.addDependency(input);
+  BOOST_CHECK(!sig1.pushesUpdates());
+  BOOST_CHECK(!sig2.pushesUpdates());
+  sig2(12);
+  sig2(13);
+  BOOST_CHECK_EQUAL(pro1.call, 4);
+}
+
+BOOST_AUTO_TEST_CASE(version_dependent_propagation) {
+  typedef dynamicgraph::TimeDependency<int> TimeDependency;
+  dynamicgraph::Signal<double, int> gain("gain");
+  gain.setConstant(2.);
+  DummyClass<double> pro1("pro1"), pro2("pro2"), pro3("pro3");
+  sigDouble_t sig1(boost::bind(&DummyClass<double>::fun, &pro1, _1, _2), gain,
+                   "sig1");
+  // sig2 does not read sig1: sig1 stays dirty while sig2 is computed.
+  sigDouble_t sig2(boost::bind(&DummyClass<double>::fun, &pro2, _1, _2), sig1,
+                   "sig2");
+  sigDouble_t sig3(boost::bind(&DummyClass<double>::fun, &pro3, _1, _2), sig2,
+                   "sig3");
+  pro3.add(sig2);
+  sig1.setDependencyType(TimeDependency::VERSION_DEPENDENT);
+  sig2.setDependencyType(TimeDependency::VERSION_DEPENDENT);
+  sig3.setDependencyType(TimeDependency::VERSION_DEPENDENT);
+  sig3(1);
+  BOOST_CHECK(sig1.TimeDependency::dirty);
+  BOOST_CHECK(!sig2.TimeDependency::dirty);
+
+  // The modification reaches sig2 although sig1 was already dirty.
+  gain.setConstant(3.);
+  BOOST_CHECK(sig2.TimeDependency::dirty);
+  BOOST_CHECK(sig3.TimeDependency::dirty);
+  sig3(2);
+  BOOST_CHECK_EQUAL(pro3.call, 2);
+
+  // So does a new dependency, or a new type of dependency.
+  dynamicgraph::Signal<double, int> offset("offset");
+  offset.setConstant(1.);
+  sig2.addDependency(offset);
+  BOOST_CHECK(sig3.TimeDependency::dirty);
+  sig3(3);
+  BOOST_CHECK_EQUAL(pro3.call, 3);
+  sig2.setDependencyType(TimeDependency::TIME_DEPENDENT);
+  sig2.setDependencyType(TimeDependency::VERSION_DEPENDENT);
+  BOOST_CHECK(sig3.TimeDependency::dirty);
+}
+
+// Signal whose dependencies are held by a TimeDependency member.
+class LeaderSignal : public dynamicgraph::Signal<double, int> {
+public:
+  LeaderSignal() : dynamicgraph::Signal<double, int>("leader"), time(this) {}
+  dynamicgraph::TimeDependency<int> time;
+};
+
+BOOST_AUTO_TEST_CASE(destroyed_dependency) {
+  DummyClass<double> pro("pro");
+  sigDouble_t sig(boost::bind(&DummyClass<double>::fun, &pro, _1, _2),
+                  dynamicgraph::sotNOSIGNAL, "sig");
+  {
+    sigDouble_t dep("dep");
+    sig.addDependency(dep);
+    BOOST_CHECK_EQUAL(dep.getDependents().size(), 1);
+    BOOST_CHECK_EQUAL(sig.dependencies.size(), 1);
+  }
+  // The destroyed signal is removed from the dependencies.
+  BOOST_CHECK(sig.dependencies.empty());
+
+  // Even when the leader is not a SignalTimeDependent.
+  LeaderSignal leader;
+  {
+    sigDouble_t dep("dep");
+    leader.time.addDependency(dep);
+    BOOST_CHECK_EQUAL(dep.getDependents().size(), 1);
+  }
+  BOOST_CHECK(leader.time.dependencies.empty());
+}
+
+BOOST_AUTO_TEST_CASE(memoized_need_update) {
+  // Chain of diamonds: each level has two paths to the previous one, the
+  // number of paths to the source doubling at each level.
+  const int N = 12;
+  sigDouble_t source("source");
+  source.setConstant(1.);
+  std::vector<sigDouble_t *> left, right;
+  const dynamicgraph::SignalBase<int> *previous = &source;
+  for (int i = 0; i < N; ++i) {
+    left.push_back(new sigDouble_t(*previous, "left"));
+    right.push_back(new sigDouble_t(*previous, "right"));
+    left[i]->setConstant(1.);
+    right[i]->setConstant(1.);
+    sigDouble_t *join = new sigDouble_t(*left[i] << *right[i], "join");
+    join->setConstant(1.);
+    left.push_back(join);
+    previous = join;
+  }
+  for (std::size_t i = 0; i < left.size(); ++i)
+    (*left[i])(1);
+  for (std::size_t i = 0; i < right.size(); ++i)
+    (*right[i])(1);
+  source(1);
+
+  // The answer does not change while nothing is modified.
+  BOOST_CHECK(!previous->needUpdate(2));
+  BOOST_CHECK(!previous->needUpdate(2));
+  // The dependencies of each signal are checked once, the source and the
+  // joins being reached a second time through the other path of the
+  // diamond. The second query is answered directly.
+  unsigned long memoized = source.getNbMemoizedQueries();
+  for (std::size_t i = 0; i < left.size(); ++i)
+    memoized += left[i]->getNbMemoizedQueries();
+  for (std::size_t i = 0; i < right.size(); ++i)
+    memoized += right[i]->getNbMemoizedQueries();
+  BOOST_CHECK_EQUAL(memoized, N + 1);
+
+  // Modifying the source invalidates the memoized results.
+  source.setConstant(2.);
+  BOOST_CHECK(previous->needUpdate(2));
+
+  for (std::size_t i = 0; i < left.size(); ++i)
+    delete left[i];
+  for (std::size_t i = 0; i < right.size(); ++i)
+    delete right[i];
+}